@@ -0,0 +1,443 @@
+/*
+ * This file was generated automatically by ExtUtils::ParseXS version 3.45 from the
+ * contents of LibYAML.xs. Do not edit this file, edit LibYAML.xs instead.
+ *
+ *    ANY CHANGES MADE HERE WILL BE LOST!
+ *
+ */
+
+#line 1 "LibYAML.xs"
+#include <perl_libyaml.h>
+/* XXX Make -Wall not complain about 'local_patches' not being used. */
+#if !defined(PERL_PATCHLEVEL_H_IMPLICIT)
+void xxx_local_patches_xs() { printf("%s", local_patches[0]); }
+#endif
+
+#line 17 "LibYAML.c"
+#ifndef PERL_UNUSED_VAR
+#  define PERL_UNUSED_VAR(var) if (0) var = var
+#endif
+
+#ifndef dVAR
+#  define dVAR		dNOOP
+#endif
+
+
+/* This stuff is not part of the API! You have been warned. */
+#ifndef PERL_VERSION_DECIMAL
+#  define PERL_VERSION_DECIMAL(r,v,s) (r*1000000 + v*1000 + s)
+#endif
+#ifndef PERL_DECIMAL_VERSION
+#  define PERL_DECIMAL_VERSION \
+	  PERL_VERSION_DECIMAL(PERL_REVISION,PERL_VERSION,PERL_SUBVERSION)
+#endif
+#ifndef PERL_VERSION_GE
+#  define PERL_VERSION_GE(r,v,s) \
+	  (PERL_DECIMAL_VERSION >= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+#ifndef PERL_VERSION_LE
+#  define PERL_VERSION_LE(r,v,s) \
+	  (PERL_DECIMAL_VERSION <= PERL_VERSION_DECIMAL(r,v,s))
+#endif
+
+/* XS_INTERNAL is the explicit static-linkage variant of the default
+ * XS macro.
+ *
+ * XS_EXTERNAL is the same as XS_INTERNAL except it does not include
+ * "STATIC", ie. it exports XSUB symbols. You probably don't want that
+ * for anything but the BOOT XSUB.
+ *
+ * See XSUB.h in core!
+ */
+
+
+/* TODO: This might be compatible further back than 5.10.0. */
+#if PERL_VERSION_GE(5, 10, 0) && PERL_VERSION_LE(5, 15, 1)
+#  undef XS_EXTERNAL
+#  undef XS_INTERNAL
+#  if defined(__CYGWIN__) && defined(USE_DYNAMIC_LOADING)
+#    define XS_EXTERNAL(name) __declspec(dllexport) XSPROTO(name)
+#    define XS_INTERNAL(name) STATIC XSPROTO(name)
+#  endif
+#  if defined(__SYMBIAN32__)
+#    define XS_EXTERNAL(name) EXPORT_C XSPROTO(name)
+#    define XS_INTERNAL(name) EXPORT_C STATIC XSPROTO(name)
+#  endif
+#  ifndef XS_EXTERNAL
+#    if defined(HASATTRIBUTE_UNUSED) && !defined(__cplusplus)
+#      define XS_EXTERNAL(name) void name(pTHX_ CV* cv __attribute__unused__)
+#      define XS_INTERNAL(name) STATIC void name(pTHX_ CV* cv __attribute__unused__)
+#    else
+#      ifdef __cplusplus
+#        define XS_EXTERNAL(name) extern "C" XSPROTO(name)
+#        define XS_INTERNAL(name) static XSPROTO(name)
+#      else
+#        define XS_EXTERNAL(name) XSPROTO(name)
+#        define XS_INTERNAL(name) STATIC XSPROTO(name)
+#      endif
+#    endif
+#  endif
+#endif
+
+/* perl >= 5.10.0 && perl <= 5.15.1 */
+
+
+/* The XS_EXTERNAL macro is used for functions that must not be static
+ * like the boot XSUB of a module. If perl didn't have an XS_EXTERNAL
+ * macro defined, the best we can do is assume XS is the same.
+ * Dito for XS_INTERNAL.
+ */
+#ifndef XS_EXTERNAL
+#  define XS_EXTERNAL(name) XS(name)
+#endif
+#ifndef XS_INTERNAL
+#  define XS_INTERNAL(name) XS(name)
+#endif
+
+/* Now, finally, after all this mess, we want an ExtUtils::ParseXS
+ * internal macro that we're free to redefine for varying linkage due
+ * to the EXPORT_XSUB_SYMBOLS XS keyword. This is internal, use
+ * XS_EXTERNAL(name) or XS_INTERNAL(name) in your code if you need to!
+ */
+
+#undef XS_EUPXS
+#if defined(PERL_EUPXS_ALWAYS_EXPORT)
+#  define XS_EUPXS(name) XS_EXTERNAL(name)
+#else
+   /* default to internal */
+#  define XS_EUPXS(name) XS_INTERNAL(name)
+#endif
+
+#ifndef PERL_ARGS_ASSERT_CROAK_XS_USAGE
+#define PERL_ARGS_ASSERT_CROAK_XS_USAGE assert(cv); assert(params)
+
+/* prototype to pass -Wmissing-prototypes */
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params);
+
+STATIC void
+S_croak_xs_usage(const CV *const cv, const char *const params)
+{
+    const GV *const gv = CvGV(cv);
+
+    PERL_ARGS_ASSERT_CROAK_XS_USAGE;
+
+    if (gv) {
+        const char *const gvname = GvNAME(gv);
+        const HV *const stash = GvSTASH(gv);
+        const char *const hvname = stash ? HvNAME(stash) : NULL;
+
+        if (hvname)
+	    Perl_croak_nocontext("Usage: %s::%s(%s)", hvname, gvname, params);
+        else
+	    Perl_croak_nocontext("Usage: %s(%s)", gvname, params);
+    } else {
+        /* Pants. I don't think that it should be possible to get here. */
+	Perl_croak_nocontext("Usage: CODE(0x%" UVxf ")(%s)", PTR2UV(cv), params);
+    }
+}
+#undef  PERL_ARGS_ASSERT_CROAK_XS_USAGE
+
+#define croak_xs_usage        S_croak_xs_usage
+
+#endif
+
+/* NOTE: the prototype of newXSproto() is different in versions of perls,
+ * so we define a portable version of newXSproto()
+ */
+#ifdef newXS_flags
+#define newXSproto_portable(name, c_impl, file, proto) newXS_flags(name, c_impl, file, proto, 0)
+#else
+#define newXSproto_portable(name, c_impl, file, proto) (PL_Sv=(SV*)newXS(name, c_impl, file), sv_setpv(PL_Sv, proto), (CV*)PL_Sv)
+#endif /* !defined(newXS_flags) */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  define newXS_deffile(a,b) Perl_newXS(aTHX_ a,b,file)
+#else
+#  define newXS_deffile(a,b) Perl_newXS_deffile(aTHX_ a,b)
+#endif
+
+#line 161 "LibYAML.c"
+
+XS_EUPXS(XS_YAML__XS__LibYAML_CLONE); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML_CLONE)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    {
+#line 18 "LibYAML.xs"
+        clone_pools();
+#line 172 "LibYAML.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML_Load); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML_Load)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "yaml_sv");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	SV *	yaml_sv = ST(0)
+;
+#line 24 "LibYAML.xs"
+        PL_markstack_ptr++;
+        Load(yaml_sv);
+        return;
+#line 193 "LibYAML.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML_LoadFile); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML_LoadFile)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "filename_sv");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	SV *	filename_sv = ST(0)
+;
+#line 32 "LibYAML.xs"
+        PL_markstack_ptr++;
+        LoadFile(filename_sv);
+        return;
+#line 215 "LibYAML.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML_Dump); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML_Dump)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 39 "LibYAML.xs"
+        SV *dummy = NULL;
+        PL_markstack_ptr++;
+        Dump(dummy);
+        return;
+#line 236 "LibYAML.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML_DumpFile); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML_DumpFile)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+#line 47 "LibYAML.xs"
+        SV *dummy = NULL;
+        PL_markstack_ptr++;
+        DumpFile(dummy);
+        return;
+#line 257 "LibYAML.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_new); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_new)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "class");
+    {
+	char *	class = (char *)SvPV_nolen(ST(0))
+;
+	SV *	RETVAL;
+#line 59 "LibYAML.xs"
+        RETVAL = newSV(0);
+        sv_setref_pv(RETVAL, class, (void *)new_stream_loader());
+#line 277 "LibYAML.c"
+	RETVAL = sv_2mortal(RETVAL);
+	ST(0) = RETVAL;
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_feed); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_feed)
+{
+    dVAR; dXSARGS;
+    if (items != 2)
+       croak_xs_usage(cv,  "self, chunk_sv");
+    {
+	SV *	self = ST(0)
+;
+	SV *	chunk_sv = ST(1)
+;
+#line 69 "LibYAML.xs"
+        feed_stream(get_stream_loader(self), chunk_sv, 0);
+#line 298 "LibYAML.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_finish); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_finish)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	SV *	self = ST(0)
+;
+#line 75 "LibYAML.xs"
+        feed_stream(get_stream_loader(self), NULL, 1);
+#line 315 "LibYAML.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_next_document); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_next_document)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    PERL_UNUSED_VAR(ax); /* -Wall */
+    SP -= items;
+    {
+	SV *	self = ST(0)
+;
+#line 81 "LibYAML.xs"
+        SV *node;
+#line 334 "LibYAML.c"
+#line 83 "LibYAML.xs"
+        PUTBACK;
+        node = load_stream_document(get_stream_loader(self));
+        SPAGAIN;
+        if (node)
+            XPUSHs(sv_2mortal(node));
+#line 341 "LibYAML.c"
+	PUTBACK;
+	return;
+    }
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_CLONE_SKIP); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_CLONE_SKIP)
+{
+    dVAR; dXSARGS;
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+    {
+	int	RETVAL;
+	dXSTARG;
+#line 92 "LibYAML.xs"
+        /* A new thread gets undef, as the loader can only be freed once. */
+        RETVAL = 1;
+#line 360 "LibYAML.c"
+	XSprePUSH;
+	PUSHi((IV)RETVAL);
+    }
+    XSRETURN(1);
+}
+
+
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_DESTROY); /* prototype to pass -Wmissing-prototypes */
+XS_EUPXS(XS_YAML__XS__LibYAML__Stream_DESTROY)
+{
+    dVAR; dXSARGS;
+    if (items != 1)
+       croak_xs_usage(cv,  "self");
+    {
+	SV *	self = ST(0)
+;
+#line 101 "LibYAML.xs"
+        free_stream_loader(get_stream_loader(self));
+#line 379 "LibYAML.c"
+    }
+    XSRETURN_EMPTY;
+}
+
+#ifdef __cplusplus
+extern "C"
+#endif
+XS_EXTERNAL(boot_YAML__XS__LibYAML); /* prototype to pass -Wmissing-prototypes */
+XS_EXTERNAL(boot_YAML__XS__LibYAML)
+{
+#if PERL_VERSION_LE(5, 21, 5)
+    dVAR; dXSARGS;
+#else
+    dVAR; dXSBOOTARGSXSAPIVERCHK;
+#endif
+#if PERL_VERSION_LE(5, 8, 999) /* PERL_VERSION_LT is 5.33+ */
+    char* file = __FILE__;
+#else
+    const char* file = __FILE__;
+#endif
+
+    PERL_UNUSED_VAR(file);
+
+    PERL_UNUSED_VAR(cv); /* -W */
+    PERL_UNUSED_VAR(items); /* -W */
+#if PERL_VERSION_LE(5, 21, 5)
+    XS_VERSION_BOOTCHECK;
+#  ifdef XS_APIVERSION_BOOTCHECK
+    XS_APIVERSION_BOOTCHECK;
+#  endif
+#endif
+
+        newXS_deffile("YAML::XS::LibYAML::CLONE", XS_YAML__XS__LibYAML_CLONE);
+        newXS_deffile("YAML::XS::LibYAML::Load", XS_YAML__XS__LibYAML_Load);
+        newXS_deffile("YAML::XS::LibYAML::LoadFile", XS_YAML__XS__LibYAML_LoadFile);
+        newXS_deffile("YAML::XS::LibYAML::Dump", XS_YAML__XS__LibYAML_Dump);
+        newXS_deffile("YAML::XS::LibYAML::DumpFile", XS_YAML__XS__LibYAML_DumpFile);
+        newXS_deffile("YAML::XS::LibYAML::Stream::new", XS_YAML__XS__LibYAML__Stream_new);
+        newXS_deffile("YAML::XS::LibYAML::Stream::feed", XS_YAML__XS__LibYAML__Stream_feed);
+        newXS_deffile("YAML::XS::LibYAML::Stream::finish", XS_YAML__XS__LibYAML__Stream_finish);
+        newXS_deffile("YAML::XS::LibYAML::Stream::next_document", XS_YAML__XS__LibYAML__Stream_next_document);
+        newXS_deffile("YAML::XS::LibYAML::Stream::CLONE_SKIP", XS_YAML__XS__LibYAML__Stream_CLONE_SKIP);
+        newXS_deffile("YAML::XS::LibYAML::Stream::DESTROY", XS_YAML__XS__LibYAML__Stream_DESTROY);
+
+    /* Initialisation Section */
+
+#line 12 "LibYAML.xs"
+        init_allocator();
+        init_pools();
+
+#line 430 "LibYAML.c"
+
+    /* End of Initialisation Section */
+
+#if PERL_VERSION_LE(5, 21, 5)
+#  if PERL_VERSION_GE(5, 9, 0)
+    if (PL_unitcheckav)
+        call_list(PL_scopestack_ix, PL_unitcheckav);
+#  endif
+    XSRETURN_YES;
+#else
+    Perl_xs_boot_epilog(aTHX_ ax);
+#endif
+}
+
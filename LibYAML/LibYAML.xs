@@ -8,6 +8,15 @@ MODULE = YAML::XS::LibYAML		PACKAGE = YAML::XS::LibYAML
 
 PROTOTYPES: DISABLE
 
+BOOT:
+        init_allocator();
+        init_pools();
+
+void
+CLONE (...)
+        CODE:
+        clone_pools();
+
 void
 Load (yaml_sv)
         SV *yaml_sv
@@ -16,6 +25,14 @@ Load (yaml_sv)
         Load(yaml_sv);
         return;
 
+void
+LoadFile (filename_sv)
+        SV *filename_sv
+        PPCODE:
+        PL_markstack_ptr++;
+        LoadFile(filename_sv);
+        return;
+
 void
 Dump (...)
         PPCODE:
@@ -24,3 +41,61 @@ Dump (...)
         Dump(dummy);
         return;
 
+void
+DumpFile (...)
+        PPCODE:
+        SV *dummy = NULL;
+        PL_markstack_ptr++;
+        DumpFile(dummy);
+        return;
+
+
+MODULE = YAML::XS::LibYAML		PACKAGE = YAML::XS::LibYAML::Stream
+
+SV *
+new (class)
+        char *class
+        CODE:
+        RETVAL = newSV(0);
+        sv_setref_pv(RETVAL, class, (void *)new_stream_loader());
+        OUTPUT:
+        RETVAL
+
+void
+feed (self, chunk_sv)
+        SV *self
+        SV *chunk_sv
+        CODE:
+        feed_stream(get_stream_loader(self), chunk_sv, 0);
+
+void
+finish (self)
+        SV *self
+        CODE:
+        feed_stream(get_stream_loader(self), NULL, 1);
+
+void
+next_document (self)
+        SV *self
+        PREINIT:
+        SV *node;
+        PPCODE:
+        PUTBACK;
+        node = load_stream_document(get_stream_loader(self));
+        SPAGAIN;
+        if (node)
+            XPUSHs(sv_2mortal(node));
+
+int
+CLONE_SKIP (...)
+        CODE:
+        /* A new thread gets undef, as the loader can only be freed once. */
+        RETVAL = 1;
+        OUTPUT:
+        RETVAL
+
+void
+DESTROY (self)
+        SV *self
+        CODE:
+        free_stream_loader(get_stream_loader(self));
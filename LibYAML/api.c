@@ -1,6 +1,11 @@
 
 #include "yaml_private.h"
 
+#if defined(HAVE_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 /*
  * Get the library version.
  */
@@ -23,34 +28,151 @@ yaml_get_version(int *major, int *minor, int *patch)
     *patch = YAML_VERSION_PATCH;
 }
 
+/*
+ * The character classes of octets.
+ */
+
+#define A   YAML_CHAR_ALPHA
+#define D   YAML_CHAR_DIGIT
+#define H   YAML_CHAR_HEX
+#define P   YAML_CHAR_PRINTABLE
+#define B   YAML_CHAR_BLANK
+#define L   YAML_CHAR_BREAK
+#define Z   YAML_CHAR_Z
+#define M   YAML_CHAR_LEAD
+
+YAML_DECLARE(const unsigned char) yaml_char_classes[256] = {
+    /* 00 */ Z, 0, 0, 0, 0, 0, 0, 0,
+    /* 08 */ 0, B, P|L, 0, 0, L, 0, 0,
+    /* 10 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 18 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 20 */ P|B, P, P, P, P, P, P, P,
+    /* 28 */ P, P, P, P, P, A|P, P, P,
+    /* 30 */ A|D|H|P, A|D|H|P, A|D|H|P, A|D|H|P, A|D|H|P, A|D|H|P, A|D|H|P, A|D|H|P,
+    /* 38 */ A|D|H|P, A|D|H|P, P, P, P, P, P, P,
+    /* 40 */ P, A|H|P, A|H|P, A|H|P, A|H|P, A|H|P, A|H|P, A|P,
+    /* 48 */ A|P, A|P, A|P, A|P, A|P, A|P, A|P, A|P,
+    /* 50 */ A|P, A|P, A|P, A|P, A|P, A|P, A|P, A|P,
+    /* 58 */ A|P, A|P, A|P, P, P, P, P, A|P,
+    /* 60 */ P, A|H|P, A|H|P, A|H|P, A|H|P, A|H|P, A|H|P, A|P,
+    /* 68 */ A|P, A|P, A|P, A|P, A|P, A|P, A|P, A|P,
+    /* 70 */ A|P, A|P, A|P, A|P, A|P, A|P, A|P, A|P,
+    /* 78 */ A|P, A|P, A|P, P, P, P, P, 0,
+    /* 80 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 88 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 90 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* 98 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* A0 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* A8 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* B0 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* B8 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* C0 */ 0, 0, M, 0, 0, 0, 0, 0,
+    /* C8 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* D0 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* D8 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* E0 */ 0, 0, M, 0, 0, 0, 0, 0,
+    /* E8 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* F0 */ 0, 0, 0, 0, 0, 0, 0, 0,
+    /* F8 */ 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+#undef A
+#undef D
+#undef H
+#undef P
+#undef B
+#undef L
+#undef Z
+#undef M
+
+/*
+ * The global allocator.  Without functions, it is the C library allocator.
+ */
+
+static yaml_allocator_t yaml_global_allocator = { NULL, NULL, NULL, NULL };
+
+/*
+ * Set the global allocator.
+ */
+
+YAML_DECLARE(void)
+yaml_set_allocator(const yaml_allocator_t *allocator)
+{
+    if (allocator) {
+        assert(allocator->malloc_handler && allocator->realloc_handler
+                && allocator->free_handler);    /* Functions are expected. */
+        yaml_global_allocator = *allocator;
+    }
+    else {
+        memset(&yaml_global_allocator, 0, sizeof(yaml_allocator_t));
+    }
+}
+
 /*
  * Allocate a dynamic memory block.
  */
 
+YAML_DECLARE(void *)
+yaml_allocator_malloc(const yaml_allocator_t *allocator, size_t size)
+{
+    if (!allocator) allocator = &yaml_global_allocator;
+    if (!size) size = 1;
+
+    return allocator->malloc_handler
+        ? allocator->malloc_handler(allocator->data, size) : malloc(size);
+}
+
 YAML_DECLARE(void *)
 yaml_malloc(size_t size)
 {
-    return malloc(size ? size : 1);
+    return yaml_allocator_malloc(NULL, size);
 }
 
 /*
  * Reallocate a dynamic memory block.
  */
 
+YAML_DECLARE(void *)
+yaml_allocator_realloc(const yaml_allocator_t *allocator, void *ptr,
+        size_t size)
+{
+    if (!ptr) return yaml_allocator_malloc(allocator, size);
+    if (!allocator) allocator = &yaml_global_allocator;
+    if (!size) size = 1;
+
+    return allocator->realloc_handler
+        ? allocator->realloc_handler(allocator->data, ptr, size)
+        : realloc(ptr, size);
+}
+
 YAML_DECLARE(void *)
 yaml_realloc(void *ptr, size_t size)
 {
-    return ptr ? realloc(ptr, size ? size : 1) : malloc(size ? size : 1);
+    return yaml_allocator_realloc(NULL, ptr, size);
 }
 
 /*
  * Free a dynamic memory block.
  */
 
+YAML_DECLARE(void)
+yaml_allocator_free(const yaml_allocator_t *allocator, void *ptr)
+{
+    if (!ptr) return;
+    if (!allocator) allocator = &yaml_global_allocator;
+
+    if (allocator->free_handler) {
+        allocator->free_handler(allocator->data, ptr);
+    }
+    else {
+        free(ptr);
+    }
+}
+
 YAML_DECLARE(void)
 yaml_free(void *ptr)
 {
-    if (ptr) free(ptr);
+    yaml_allocator_free(NULL, ptr);
 }
 
 /*
@@ -58,27 +180,113 @@ yaml_free(void *ptr)
  */
 
 YAML_DECLARE(yaml_char_t *)
-yaml_strdup(const yaml_char_t *str)
+yaml_allocator_strdup(const yaml_allocator_t *allocator,
+        const yaml_char_t *str)
 {
+    size_t size;
+    yaml_char_t *copy;
+
     if (!str)
         return NULL;
 
-    return (yaml_char_t *)strdup((char *)str);
+    size = strlen((char *)str) + 1;
+    copy = yaml_allocator_malloc(allocator, size);
+    if (copy) {
+        memcpy(copy, str, size);
+    }
+
+    return copy;
+}
+
+YAML_DECLARE(yaml_char_t *)
+yaml_strdup(const yaml_char_t *str)
+{
+    return yaml_allocator_strdup(NULL, str);
+}
+
+/*
+ * Allocate a string in the arena of a parser.
+ *
+ * The arena is a chain of blocks, each starting with a pointer to the
+ * previous one.  A new block is at least twice as large as the last one.
+ */
+
+YAML_DECLARE(yaml_char_t *)
+yaml_arena_alloc(yaml_parser_t *parser, size_t size)
+{
+    if ((size_t)(parser->arena.end - parser->arena.pointer) < size)
+    {
+        size_t block_size = parser->arena.start
+            ? (parser->arena.end - parser->arena.start)*2 : INITIAL_ARENA_SIZE;
+        yaml_char_t *block;
+
+        while (block_size < sizeof(yaml_char_t *) + size) {
+            block_size *= 2;
+        }
+        if (!(block = CONTEXT_MALLOC(parser, block_size)))
+            return NULL;
+
+        *(yaml_char_t **)block = parser->arena.start;
+        parser->arena.start = block;
+        parser->arena.pointer = block + sizeof(yaml_char_t *);
+        parser->arena.end = block + block_size;
+    }
+
+    parser->arena.pointer += size;
+
+    return parser->arena.pointer - size;
+}
+
+/*
+ * Release every string of the arena, keeping its last block for reuse.
+ */
+
+YAML_DECLARE(void)
+yaml_arena_release(yaml_parser_t *parser)
+{
+    yaml_char_t *block;
+
+    if (!parser->arena.start)
+        return;
+
+    block = *(yaml_char_t **)parser->arena.start;
+    while (block) {
+        yaml_char_t *previous = *(yaml_char_t **)block;
+        CONTEXT_FREE(parser, block);
+        block = previous;
+    }
+
+    *(yaml_char_t **)parser->arena.start = NULL;
+    parser->arena.pointer = parser->arena.start + sizeof(yaml_char_t *);
 }
 
 /*
- * Extend a string.
+ * Extend a string.  The last string of an arena grows in place.
  */
 
 YAML_DECLARE(int)
-yaml_string_extend(yaml_char_t **start,
+yaml_string_extend(yaml_parser_t *parser, yaml_char_t **start,
         yaml_char_t **pointer, yaml_char_t **end)
 {
-    yaml_char_t *new_start = yaml_realloc(*start, (*end - *start)*2);
+    size_t size = *end - *start;
+    yaml_char_t *new_start;
 
-    if (!new_start) return 0;
+    if (!ARENA_USED(parser)) {
+        new_start = yaml_allocator_realloc(parser->allocator, *start, size*2);
+        if (!new_start) return 0;
+    }
+    else if (*end == parser->arena.pointer
+            && (size_t)(parser->arena.end - parser->arena.pointer) >= size) {
+        parser->arena.pointer += size;
+        new_start = *start;
+    }
+    else {
+        new_start = yaml_arena_alloc(parser, size*2);
+        if (!new_start) return 0;
+        memcpy(new_start, *start, size);
+    }
 
-    memset(new_start + (*end - *start), 0, *end - *start);
+    memset(new_start + size, 0, size);
 
     *pointer = new_start + (*pointer - *start);
     *end = new_start + (*end - *start)*2;
@@ -92,7 +300,7 @@ yaml_string_extend(yaml_char_t **start,
  */
 
 YAML_DECLARE(int)
-yaml_string_join(
+yaml_string_join(yaml_parser_t *parser,
         yaml_char_t **a_start, yaml_char_t **a_pointer, yaml_char_t **a_end,
         yaml_char_t **b_start, yaml_char_t **b_pointer, yaml_char_t **b_end)
 {
@@ -100,7 +308,7 @@ yaml_string_join(
         return 1;
 
     while (*a_end - *a_pointer <= *b_pointer - *b_start) {
-        if (!yaml_string_extend(a_start, a_pointer, a_end))
+        if (!yaml_string_extend(parser, a_start, a_pointer, a_end))
             return 0;
     }
 
@@ -110,14 +318,34 @@ yaml_string_join(
     return 1;
 }
 
+/*
+ * Move a stack or a queue from the storage inside its context object into a
+ * new allocated block.
+ */
+
+static void *
+yaml_inline_extend(const yaml_allocator_t *allocator, void *start, size_t size)
+{
+    void *new_start = yaml_allocator_malloc(allocator, size*2);
+
+    if (new_start) {
+        memcpy(new_start, start, size);
+    }
+
+    return new_start;
+}
+
 /*
  * Extend a stack.
  */
 
 YAML_DECLARE(int)
-yaml_stack_extend(void **start, void **top, void **end)
+yaml_stack_extend(const yaml_allocator_t *allocator,
+        void **start, void **top, void **end, int is_inline)
 {
-    void *new_start = yaml_realloc(*start, ((char *)*end - (char *)*start)*2);
+    size_t size = (char *)*end - (char *)*start;
+    void *new_start = is_inline ? yaml_inline_extend(allocator, *start, size)
+        : yaml_allocator_realloc(allocator, *start, size*2);
 
     if (!new_start) return 0;
 
@@ -129,39 +357,53 @@ yaml_stack_extend(void **start, void **top, void **end)
 }
 
 /*
- * Extend or move a queue.
+ * Extend a full queue.  The items are unwrapped to the beginning of the new
+ * buffer.
  */
 
 YAML_DECLARE(int)
-yaml_queue_extend(void **start, void **head, void **tail, void **end)
+yaml_queue_extend(const yaml_allocator_t *allocator,
+        void **start, size_t *mask, size_t *head, size_t *tail,
+        size_t size, int is_inline)
 {
-    /* Check if we need to resize the queue. */
+    size_t length = (*mask+1)*size;
+    size_t first = (*head & *mask)*size;
+    void *new_start = yaml_allocator_malloc(allocator, length*2);
 
-    if (*start == *head && *tail == *end) {
-        void *new_start = yaml_realloc(*start,
-                ((char *)*end - (char *)*start)*2);
+    if (!new_start) return 0;
 
-        if (!new_start) return 0;
+    memcpy(new_start, (char *)*start + first, length - first);
+    memcpy((char *)new_start + length - first, *start, first);
 
-        *head = (char *)new_start + ((char *)*head - (char *)*start);
-        *tail = (char *)new_start + ((char *)*tail - (char *)*start);
-        *end = (char *)new_start + ((char *)*end - (char *)*start)*2;
-        *start = new_start;
+    if (!is_inline) {
+        yaml_allocator_free(allocator, *start);
     }
 
-    /* Check if we need to move the queue at the beginning of the buffer. */
-
-    if (*tail == *end) {
-        if (*head != *tail) {
-            memmove(*start, *head, (char *)*tail - (char *)*head);
-        }
-        *tail = (char *)*tail - (char *)*head + (char *)*start;
-        *head = *start;
-    }
+    *start = new_start;
+    *mask = *mask*2+1;
+    *tail -= *head;
+    *head = 0;
 
     return 1;
 }
 
+/*
+ * Move the items of a queue from the index on by one position to the tail.
+ * The queue must have room for another item.
+ */
+
+YAML_DECLARE(void)
+yaml_queue_insert(void *start, size_t mask, size_t head, size_t tail,
+        size_t index, size_t size)
+{
+    size_t position;
+
+    for (position = tail; position != head+index; position --) {
+        memcpy((char *)start + (position & mask)*size,
+                (char *)start + ((position-1) & mask)*size, size);
+    }
+}
+
 
 /*
  * Create a new parser object.
@@ -173,66 +415,129 @@ yaml_parser_initialize(yaml_parser_t *parser)
     assert(parser);     /* Non-NULL parser object expected. */
 
     memset(parser, 0, sizeof(yaml_parser_t));
-    if (!BUFFER_INIT(parser, parser->raw_buffer, INPUT_RAW_BUFFER_SIZE))
-        goto error;
-    if (!BUFFER_INIT(parser, parser->buffer, INPUT_BUFFER_SIZE))
-        goto error;
-    if (!QUEUE_INIT(parser, parser->tokens, INITIAL_QUEUE_SIZE))
-        goto error;
-    if (!STACK_INIT(parser, parser->indents, INITIAL_STACK_SIZE))
-        goto error;
-    if (!STACK_INIT(parser, parser->simple_keys, INITIAL_STACK_SIZE))
-        goto error;
-    if (!STACK_INIT(parser, parser->states, INITIAL_STACK_SIZE))
-        goto error;
-    if (!STACK_INIT(parser, parser->marks, INITIAL_STACK_SIZE))
-        goto error;
-    if (!STACK_INIT(parser, parser->tag_directives, INITIAL_STACK_SIZE))
-        goto error;
+    parser->buffer_size = INPUT_RAW_BUFFER_SIZE;
+    QUEUE_INIT_INLINE(parser, parser->tokens, parser->storage.tokens);
+    STACK_INIT_INLINE(parser, parser->indents, parser->storage.indents);
+    STACK_INIT_INLINE(parser, parser->simple_keys,
+            parser->storage.simple_keys);
+    STACK_INIT_INLINE(parser, parser->states, parser->storage.states);
+    STACK_INIT_INLINE(parser, parser->marks, parser->storage.marks);
+    STACK_INIT_INLINE(parser, parser->tag_directives,
+            parser->storage.tag_directives);
+    parser->tags.start = parser->storage.tags;
+    parser->tags.end = parser->storage.tags
+        + sizeof(parser->storage.tags)/sizeof(*parser->storage.tags);
 
     return 1;
+}
 
-error:
+/*
+ * Destroy a parser object.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_delete(yaml_parser_t *parser)
+{
+    assert(parser); /* Non-NULL parser object expected. */
 
     BUFFER_DEL(parser, parser->raw_buffer);
-    BUFFER_DEL(parser, parser->buffer);
+    if (!parser->in_place) {
+        BUFFER_DEL(parser, parser->buffer);
+    }
+#if defined(HAVE_MMAP)
+    if (parser->mapping.start) {
+        munmap(parser->mapping.start, parser->mapping.size);
+    }
+#endif
+    if (!ARENA_USED(parser)) {
+        while (!QUEUE_EMPTY(parser, parser->tokens)) {
+            TOKEN_DEL(parser, DEQUEUE(parser, parser->tokens));
+        }
+    }
     QUEUE_DEL(parser, parser->tokens);
     STACK_DEL(parser, parser->indents);
     STACK_DEL(parser, parser->simple_keys);
     STACK_DEL(parser, parser->states);
     STACK_DEL(parser, parser->marks);
+    yaml_parser_delete_tag_directives(parser);
     STACK_DEL(parser, parser->tag_directives);
+    yaml_arena_release(parser);
+    CONTEXT_FREE(parser, parser->arena.start);
 
-    return 0;
+    memset(parser, 0, sizeof(yaml_parser_t));
 }
 
 /*
- * Destroy a parser object.
+ * Reset a parser object keeping its allocations.
  */
 
 YAML_DECLARE(void)
-yaml_parser_delete(yaml_parser_t *parser)
+yaml_parser_reset(yaml_parser_t *parser)
 {
+    yaml_parser_t kept;
+
     assert(parser); /* Non-NULL parser object expected. */
 
-    BUFFER_DEL(parser, parser->raw_buffer);
-    BUFFER_DEL(parser, parser->buffer);
-    while (!QUEUE_EMPTY(parser, parser->tokens)) {
-        yaml_token_delete(&DEQUEUE(parser, parser->tokens));
+    /* Release the data of the previous input. */
+
+#if defined(HAVE_MMAP)
+    if (parser->mapping.start) {
+        munmap(parser->mapping.start, parser->mapping.size);
     }
-    QUEUE_DEL(parser, parser->tokens);
-    STACK_DEL(parser, parser->indents);
-    STACK_DEL(parser, parser->simple_keys);
-    STACK_DEL(parser, parser->states);
-    STACK_DEL(parser, parser->marks);
-    while (!STACK_EMPTY(parser, parser->tag_directives)) {
-        yaml_tag_directive_t tag_directive = POP(parser, parser->tag_directives);
-        yaml_free(tag_directive.handle);
-        yaml_free(tag_directive.prefix);
+#endif
+    if (!ARENA_USED(parser)) {
+        while (!QUEUE_EMPTY(parser, parser->tokens)) {
+            TOKEN_DEL(parser, DEQUEUE(parser, parser->tokens));
+        }
     }
-    STACK_DEL(parser, parser->tag_directives);
+    yaml_parser_delete_tag_directives(parser);
+    yaml_arena_release(parser);
+
+    /*
+     * The working buffer is kept only along with the raw buffer.  Otherwise
+     * it points into an input string or holds the tail of one.
+     */
 
+    if (parser->in_place) {
+        parser->buffer.start = NULL;
+    }
+    else if (!parser->raw_buffer.start) {
+        BUFFER_DEL(parser, parser->buffer);
+    }
+
+    kept = *parser;
     memset(parser, 0, sizeof(yaml_parser_t));
+
+    parser->buffer_size = kept.buffer_size;
+    parser->allocator = kept.allocator;
+    parser->raw_buffer.start = kept.raw_buffer.start;
+    parser->raw_buffer.end = kept.raw_buffer.end;
+    parser->raw_buffer.pointer = parser->raw_buffer.last = kept.raw_buffer.start;
+    parser->buffer.start = kept.buffer.start;
+    parser->buffer.end = kept.buffer.end;
+    parser->buffer.pointer = parser->buffer.last = kept.buffer.start;
+    parser->tokens.start = kept.tokens.start;
+    parser->tokens.mask = kept.tokens.mask;
+    parser->indents.start = kept.indents.start;
+    parser->indents.end = kept.indents.end;
+    parser->indents.top = kept.indents.start;
+    parser->simple_keys.start = kept.simple_keys.start;
+    parser->simple_keys.end = kept.simple_keys.end;
+    parser->simple_keys.top = kept.simple_keys.start;
+    parser->states.start = kept.states.start;
+    parser->states.end = kept.states.end;
+    parser->states.top = kept.states.start;
+    parser->marks.start = kept.marks.start;
+    parser->marks.end = kept.marks.end;
+    parser->marks.top = kept.marks.start;
+    parser->tag_directives.start = kept.tag_directives.start;
+    parser->tag_directives.end = kept.tag_directives.end;
+    parser->tag_directives.top = kept.tag_directives.start;
+    parser->tags.start = kept.tags.start;
+    parser->tags.end = kept.tags.end;
+    parser->arena.start = kept.arena.start;
+    parser->arena.pointer = kept.arena.pointer;
+    parser->arena.end = kept.arena.end;
 }
 
 /*
@@ -275,6 +580,22 @@ yaml_file_read_handler(void *data, unsigned char *buffer, size_t size,
     return !ferror(parser->input.file);
 }
 
+/*
+ * Drop the buffers kept by yaml_parser_reset() if they are too small for the
+ * new input.  The reader allocates them again.
+ */
+
+static void
+yaml_parser_fit_buffers(yaml_parser_t *parser)
+{
+    if (parser->raw_buffer.start
+            && (size_t)(parser->raw_buffer.end - parser->raw_buffer.start)
+                < INPUT_RAW_BUFFER_SIZE_FOR(parser)) {
+        BUFFER_DEL(parser, parser->raw_buffer);
+        BUFFER_DEL(parser, parser->buffer);
+    }
+}
+
 /*
  * Set a string input.
  */
@@ -293,6 +614,26 @@ yaml_parser_set_input_string(yaml_parser_t *parser,
     parser->input.string.start = input;
     parser->input.string.current = input;
     parser->input.string.end = input+size;
+    parser->input_size = size;
+
+    yaml_parser_fit_buffers(parser);
+}
+
+/*
+ * Set a string input that is read in place.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_input_string_in_place(yaml_parser_t *parser,
+        const unsigned char *input, size_t size)
+{
+    yaml_parser_set_input_string(parser, input, size);
+
+    /* The working buffer will point into the input. */
+
+    BUFFER_DEL(parser, parser->raw_buffer);
+    BUFFER_DEL(parser, parser->buffer);
+    parser->in_place = 1;
 }
 
 /*
@@ -310,6 +651,54 @@ yaml_parser_set_input_file(yaml_parser_t *parser, FILE *file)
     parser->read_handler_data = parser;
 
     parser->input.file = file;
+
+    yaml_parser_fit_buffers(parser);
+}
+
+/*
+ * Set a memory-mapped file input.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_input_mmap(yaml_parser_t *parser, FILE *file)
+{
+#if defined(HAVE_MMAP)
+    struct stat st;
+    long position;
+    void *mapping;
+#endif
+
+    assert(parser); /* Non-NULL parser object expected. */
+    assert(!parser->read_handler);  /* You can set the source only once. */
+    assert(file);   /* Non-NULL file object expected. */
+
+#if defined(HAVE_MMAP)
+
+    /* Only a regular non-empty file can be mapped. */
+
+    position = ftell(file);
+    if (position >= 0 && !fstat(fileno(file), &st) && S_ISREG(st.st_mode)
+            && st.st_size > position
+            && (off_t)(size_t)st.st_size == st.st_size) {
+        mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                fileno(file), 0);
+        if (mapping != MAP_FAILED) {
+#if defined(MADV_SEQUENTIAL)
+            madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+#endif
+            parser->mapping.start = mapping;
+            parser->mapping.size = st.st_size;
+            yaml_parser_set_input_string_in_place(parser,
+                    (unsigned char *)mapping + position, st.st_size - position);
+            return;
+        }
+    }
+
+#endif
+
+    /* Fall back to reading the file. */
+
+    yaml_parser_set_input_file(parser, file);
 }
 
 /*
@@ -326,6 +715,189 @@ yaml_parser_set_input(yaml_parser_t *parser,
 
     parser->read_handler = handler;
     parser->read_handler_data = data;
+
+    yaml_parser_fit_buffers(parser);
+}
+
+/*
+ * Move the unread part of a buffer to its beginning and make room for `size`
+ * more octets after it.
+ */
+
+static int
+yaml_parser_reserve_buffer(yaml_parser_t *parser, yaml_char_t **start,
+        yaml_char_t **end, yaml_char_t **pointer, yaml_char_t **last,
+        size_t size)
+{
+    size_t unread = *last - *pointer;
+    size_t capacity = *end - *start;
+
+    if (*pointer != *start) {
+        memmove(*start, *pointer, unread);
+    }
+    *pointer = *start;
+    *last = *start + unread;
+
+    if (capacity - unread < size) {
+        yaml_char_t *new_start;
+
+        while (capacity - unread < size) {
+            capacity *= 2;
+        }
+        new_start = yaml_allocator_realloc(parser->allocator, *start, capacity);
+        if (!new_start) {
+            parser->error = YAML_MEMORY_ERROR;
+            return 0;
+        }
+        *pointer = new_start;
+        *last = new_start + unread;
+        *end = new_start + capacity;
+        *start = new_start;
+    }
+
+    return 1;
+}
+
+/*
+ * Feed a chunk of the input.
+ */
+
+YAML_DECLARE(int)
+yaml_parser_feed(yaml_parser_t *parser,
+        const unsigned char *input, size_t size, int is_final)
+{
+    size_t raw_unread;
+
+    assert(parser); /* Non-NULL parser object expected. */
+    assert(!parser->read_handler);  /* The pushed input cannot be mixed. */
+    assert(!parser->push_final);    /* The last chunk is already fed. */
+    assert(input || !size);         /* Non-NULL input expected. */
+
+    if (!parser->raw_buffer.start) {
+        if (!BUFFER_INIT(parser, parser->raw_buffer, parser->buffer_size))
+            return 0;
+        if (!BUFFER_INIT(parser, parser->buffer,
+                    parser->buffer_size*(INPUT_BUFFER_SIZE/INPUT_RAW_BUFFER_SIZE)))
+            return 0;
+    }
+
+    /* Append the chunk to the raw buffer. */
+
+    if (!yaml_parser_reserve_buffer(parser, &parser->raw_buffer.start,
+                &parser->raw_buffer.end, &parser->raw_buffer.pointer,
+                &parser->raw_buffer.last, size))
+        return 0;
+    if (size) {
+        memcpy(parser->raw_buffer.last, input, size);
+        parser->raw_buffer.last += size;
+    }
+
+    /*
+     * Make room for decoding the whole raw buffer, the final NUL and the
+     * padding.  The scanner does not hold any pointers into the buffer
+     * between the calls, so the characters before the current position may
+     * be dropped.
+     */
+
+    raw_unread = parser->raw_buffer.last - parser->raw_buffer.pointer;
+    if (!yaml_parser_reserve_buffer(parser, &parser->buffer.start,
+                &parser->buffer.end, &parser->buffer.pointer,
+                &parser->buffer.last, raw_unread*2+1+INPUT_BUFFER_PADDING))
+        return 0;
+    memset(parser->buffer.last, 0, INPUT_BUFFER_PADDING);
+
+    parser->push = 1;
+    parser->push_final = is_final;
+    parser->input_needed = 0;
+
+    return 1;
+}
+
+/*
+ * Set the size of the input buffer.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_buffer_size(yaml_parser_t *parser, size_t size)
+{
+    assert(parser); /* Non-NULL parser object expected. */
+    assert(!parser->read_handler && !parser->push);  /* Before the input. */
+
+    if (!size) {
+        size = INPUT_RAW_BUFFER_SIZE;
+    }
+
+    parser->buffer_size = size < INPUT_MIN_RAW_BUFFER_SIZE
+        ? INPUT_MIN_RAW_BUFFER_SIZE
+        : size > INPUT_MAX_RAW_BUFFER_SIZE
+        ? INPUT_MAX_RAW_BUFFER_SIZE : size;
+}
+
+/*
+ * Let scalar values point into the input.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_borrow_scalars(yaml_parser_t *parser, int borrow)
+{
+    assert(parser); /* Non-NULL parser object expected. */
+
+    parser->borrow_scalars = borrow;
+}
+
+/*
+ * Let events share the tags resolved in a document.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_share_tags(yaml_parser_t *parser, int share)
+{
+    assert(parser); /* Non-NULL parser object expected. */
+
+    parser->share_tags = share;
+}
+
+/*
+ * Allocate the strings of each document in an arena.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_arena(yaml_parser_t *parser, int use)
+{
+    assert(parser); /* Non-NULL parser object expected. */
+    assert(!parser->read_handler && !parser->push);  /* Before the input. */
+
+    parser->use_arena = use;
+}
+
+/*
+ * Set the allocator of a parser.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_allocator(yaml_parser_t *parser,
+        const yaml_allocator_t *allocator)
+{
+    yaml_parser_t kept;
+
+    assert(parser); /* Non-NULL parser object expected. */
+    assert(!parser->read_handler && !parser->push);  /* Before the input. */
+    assert(!allocator || (allocator->malloc_handler
+                && allocator->realloc_handler && allocator->free_handler));
+                    /* Functions are expected. */
+
+    /* Free the allocations kept by yaml_parser_reset() and keep the options. */
+
+    kept = *parser;
+    yaml_parser_delete(parser);
+    yaml_parser_initialize(parser);
+
+    parser->buffer_size = kept.buffer_size;
+    parser->encoding = kept.encoding;
+    parser->borrow_scalars = kept.borrow_scalars;
+    parser->share_tags = kept.share_tags;
+    parser->use_arena = kept.use_arena;
+    parser->allocator = allocator;
 }
 
 /*
@@ -351,9 +923,11 @@ yaml_emitter_initialize(yaml_emitter_t *emitter)
     assert(emitter);    /* Non-NULL emitter object expected. */
 
     memset(emitter, 0, sizeof(yaml_emitter_t));
-    if (!BUFFER_INIT(emitter, emitter->buffer, OUTPUT_BUFFER_SIZE))
+    emitter->buffer_size = OUTPUT_BUFFER_SIZE;
+    if (!BUFFER_INIT(emitter, emitter->buffer, emitter->buffer_size))
         goto error;
-    if (!BUFFER_INIT(emitter, emitter->raw_buffer, OUTPUT_RAW_BUFFER_SIZE))
+    if (!BUFFER_INIT(emitter, emitter->raw_buffer,
+                OUTPUT_RAW_BUFFER_SIZE_FOR(emitter->buffer_size)))
         goto error;
     if (!STACK_INIT(emitter, emitter->states, INITIAL_STACK_SIZE))
         goto error;
@@ -387,7 +961,9 @@ yaml_emitter_delete(yaml_emitter_t *emitter)
 {
     assert(emitter);    /* Non-NULL emitter object expected. */
 
-    BUFFER_DEL(emitter, emitter->buffer);
+    if (!emitter->output_buffer_handler) {
+        BUFFER_DEL(emitter, emitter->buffer);
+    }
     BUFFER_DEL(emitter, emitter->raw_buffer);
     STACK_DEL(emitter, emitter->states);
     while (!QUEUE_EMPTY(emitter, emitter->events)) {
@@ -397,15 +973,72 @@ yaml_emitter_delete(yaml_emitter_t *emitter)
     STACK_DEL(emitter, emitter->indents);
     while (!STACK_EMPTY(empty, emitter->tag_directives)) {
         yaml_tag_directive_t tag_directive = POP(emitter, emitter->tag_directives);
-        yaml_free(tag_directive.handle);
-        yaml_free(tag_directive.prefix);
+        CONTEXT_FREE(emitter, tag_directive.handle);
+        CONTEXT_FREE(emitter, tag_directive.prefix);
     }
     STACK_DEL(emitter, emitter->tag_directives);
-    yaml_free(emitter->anchors);
+    CONTEXT_FREE(emitter, emitter->anchors);
 
     memset(emitter, 0, sizeof(yaml_emitter_t));
 }
 
+/*
+ * Reset an emitter object keeping its allocations.
+ */
+
+YAML_DECLARE(void)
+yaml_emitter_reset(yaml_emitter_t *emitter)
+{
+    yaml_emitter_t kept;
+
+    assert(emitter);    /* Non-NULL emitter object expected. */
+
+    /* Release the data of the previous stream. */
+
+    while (!QUEUE_EMPTY(emitter, emitter->events)) {
+        yaml_event_delete(&DEQUEUE(emitter, emitter->events));
+    }
+    while (!STACK_EMPTY(empty, emitter->tag_directives)) {
+        yaml_tag_directive_t tag_directive = POP(emitter, emitter->tag_directives);
+        CONTEXT_FREE(emitter, tag_directive.handle);
+        CONTEXT_FREE(emitter, tag_directive.prefix);
+    }
+    CONTEXT_FREE(emitter, emitter->anchors);
+
+    /*
+     * The buffer of an output buffer handler belongs to the application; the
+     * emitter allocates its own buffer again when it starts a stream.
+     */
+
+    if (emitter->output_buffer_handler) {
+        emitter->buffer.start = NULL;
+    }
+
+    kept = *emitter;
+    memset(emitter, 0, sizeof(yaml_emitter_t));
+
+    emitter->buffer_size = kept.buffer_size;
+    emitter->allocator = kept.allocator;
+    emitter->buffer.start = kept.buffer.start;
+    emitter->buffer.end = kept.buffer.end;
+    emitter->buffer.pointer = emitter->buffer.last = kept.buffer.start;
+    emitter->raw_buffer.start = kept.raw_buffer.start;
+    emitter->raw_buffer.end = kept.raw_buffer.end;
+    emitter->raw_buffer.pointer = emitter->raw_buffer.last
+        = kept.raw_buffer.start;
+    emitter->states.start = kept.states.start;
+    emitter->states.end = kept.states.end;
+    emitter->states.top = kept.states.start;
+    emitter->events.start = kept.events.start;
+    emitter->events.mask = kept.events.mask;
+    emitter->indents.start = kept.indents.start;
+    emitter->indents.end = kept.indents.end;
+    emitter->indents.top = kept.indents.start;
+    emitter->tag_directives.start = kept.tag_directives.start;
+    emitter->tag_directives.end = kept.tag_directives.end;
+    emitter->tag_directives.top = kept.tag_directives.start;
+}
+
 /*
  * String write handler.
  */
@@ -497,6 +1130,145 @@ yaml_emitter_set_output(yaml_emitter_t *emitter,
     emitter->write_handler_data = data;
 }
 
+/*
+ * Set the size of the output buffer.
+ */
+
+YAML_DECLARE(int)
+yaml_emitter_set_buffer_size(yaml_emitter_t *emitter, size_t size)
+{
+    yaml_char_t *buffer;
+    unsigned char *raw_buffer;
+
+    assert(emitter);    /* Non-NULL emitter object expected. */
+    assert(!emitter->write_handler);    /* Before the output. */
+    assert(!emitter->output_buffer_handler);
+
+    if (!size) {
+        size = OUTPUT_BUFFER_SIZE;
+    }
+    if (size < OUTPUT_MIN_BUFFER_SIZE) {
+        size = OUTPUT_MIN_BUFFER_SIZE;
+    }
+    if (size > OUTPUT_MAX_BUFFER_SIZE) {
+        size = OUTPUT_MAX_BUFFER_SIZE;
+    }
+
+    if (size == emitter->buffer_size)
+        return 1;
+
+    /*
+     * Allocate the new buffers before freeing the old ones, so that a failed
+     * call leaves the emitter as it was.  A reset emitter may have none.
+     */
+
+    buffer = CONTEXT_MALLOC(emitter, size);
+    raw_buffer = buffer ? CONTEXT_MALLOC(emitter,
+            OUTPUT_RAW_BUFFER_SIZE_FOR(size)) : NULL;
+    if (!raw_buffer) {
+        CONTEXT_FREE(emitter, buffer);
+        emitter->error = YAML_MEMORY_ERROR;
+        return 0;
+    }
+
+    BUFFER_DEL(emitter, emitter->buffer);
+    BUFFER_DEL(emitter, emitter->raw_buffer);
+
+    emitter->buffer.start = emitter->buffer.pointer
+        = emitter->buffer.last = buffer;
+    emitter->buffer.end = buffer + size;
+    emitter->raw_buffer.start = emitter->raw_buffer.pointer
+        = emitter->raw_buffer.last = raw_buffer;
+    emitter->raw_buffer.end = raw_buffer + OUTPUT_RAW_BUFFER_SIZE_FOR(size);
+
+    emitter->buffer_size = size;
+
+    return 1;
+}
+
+/*
+ * Set the allocator of an emitter.
+ */
+
+YAML_DECLARE(int)
+yaml_emitter_set_allocator(yaml_emitter_t *emitter,
+        const yaml_allocator_t *allocator)
+{
+    assert(emitter);    /* Non-NULL emitter object expected. */
+    assert(!emitter->write_handler);    /* Before the output. */
+    assert(!emitter->output_buffer_handler);
+    assert(QUEUE_EMPTY(emitter, emitter->events));
+    assert(!allocator || (allocator->malloc_handler
+                && allocator->realloc_handler && allocator->free_handler));
+                        /* Functions are expected. */
+
+    /* Replace the buffers, the queue and the stacks. */
+
+    BUFFER_DEL(emitter, emitter->buffer);
+    BUFFER_DEL(emitter, emitter->raw_buffer);
+    STACK_DEL(emitter, emitter->states);
+    QUEUE_DEL(emitter, emitter->events);
+    STACK_DEL(emitter, emitter->indents);
+    STACK_DEL(emitter, emitter->tag_directives);
+
+    emitter->allocator = allocator;
+
+    if (!BUFFER_INIT(emitter, emitter->buffer, emitter->buffer_size))
+        return 0;
+    if (!BUFFER_INIT(emitter, emitter->raw_buffer,
+                OUTPUT_RAW_BUFFER_SIZE_FOR(emitter->buffer_size)))
+        return 0;
+    if (!STACK_INIT(emitter, emitter->states, INITIAL_STACK_SIZE))
+        return 0;
+    if (!QUEUE_INIT(emitter, emitter->events, INITIAL_QUEUE_SIZE))
+        return 0;
+    if (!STACK_INIT(emitter, emitter->indents, INITIAL_STACK_SIZE))
+        return 0;
+    if (!STACK_INIT(emitter, emitter->tag_directives, INITIAL_STACK_SIZE))
+        return 0;
+
+    return 1;
+}
+
+/*
+ * Set an application buffer as the output.
+ */
+
+YAML_DECLARE(int)
+yaml_emitter_set_output_buffer(yaml_emitter_t *emitter,
+        yaml_output_buffer_handler_t *handler, void *data)
+{
+    size_t size = emitter->buffer_size;
+
+    assert(emitter);    /* Non-NULL emitter object expected. */
+    assert(!emitter->write_handler);    /* You can set the output only once. */
+    assert(!emitter->output_buffer_handler);
+    assert(handler);    /* Non-NULL handler object expected. */
+    assert(!emitter->encoding
+            || emitter->encoding == YAML_UTF8_ENCODING);    /* UTF-8 only. */
+
+    /* Replace the working buffer with the application buffer. */
+
+    BUFFER_DEL(emitter, emitter->buffer);
+
+    emitter->output_buffer_handler = handler;
+    emitter->write_handler_data = data;
+    emitter->encoding = YAML_UTF8_ENCODING;
+
+    if (!handler(data, 0, &emitter->buffer.start, &size)) {
+        emitter->buffer.start = NULL;
+        emitter->error = YAML_WRITER_ERROR;
+        emitter->problem = "Output buffer error";
+        return 0;
+    }
+
+    emitter->buffer.end = emitter->buffer.start + size;
+    emitter->buffer.pointer = emitter->buffer.start;
+    emitter->buffer.last = emitter->buffer.start;
+
+    return 1;
+}
+
 /*
  * Set the output encoding.
  */
@@ -579,28 +1351,37 @@ yaml_token_delete(yaml_token_t *token)
 {
     assert(token);  /* Non-NULL token object expected. */
 
+    /* The strings in the arena of a parser are released with it. */
+
+    if (token->arena) {
+        memset(token, 0, sizeof(yaml_token_t));
+        return;
+    }
+
     switch (token->type)
     {
         case YAML_TAG_DIRECTIVE_TOKEN:
-            yaml_free(token->data.tag_directive.handle);
-            yaml_free(token->data.tag_directive.prefix);
+            CONTEXT_FREE(token, token->data.tag_directive.handle);
+            CONTEXT_FREE(token, token->data.tag_directive.prefix);
             break;
 
         case YAML_ALIAS_TOKEN:
-            yaml_free(token->data.alias.value);
+            CONTEXT_FREE(token, token->data.alias.value);
             break;
 
         case YAML_ANCHOR_TOKEN:
-            yaml_free(token->data.anchor.value);
+            CONTEXT_FREE(token, token->data.anchor.value);
             break;
 
         case YAML_TAG_TOKEN:
-            yaml_free(token->data.tag.handle);
-            yaml_free(token->data.tag.suffix);
+            CONTEXT_FREE(token, token->data.tag.handle);
+            CONTEXT_FREE(token, token->data.tag.suffix);
             break;
 
         case YAML_SCALAR_TOKEN:
-            yaml_free(token->data.scalar.value);
+            if (!token->data.scalar.borrowed) {
+                CONTEXT_FREE(token, token->data.scalar.value);
+            }
             break;
 
         default:
@@ -610,6 +1391,18 @@ yaml_token_delete(yaml_token_t *token)
     memset(token, 0, sizeof(yaml_token_t));
 }
 
+/*
+ * Destroy a token made by the Scanner.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_token_delete(yaml_parser_t *parser, yaml_token_t *token)
+{
+    token->arena = ARENA_USED(parser);
+    token->allocator = parser->allocator;
+    yaml_token_delete(token);
+}
+
 /*
  * Check if a string is a valid UTF-8 sequence.
  *
@@ -701,6 +1494,7 @@ yaml_document_start_event_initialize(yaml_event_t *event,
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
     yaml_mark_t mark = { 0, 0, 0 };
     yaml_version_directive_t *version_directive_copy = NULL;
@@ -716,6 +1510,8 @@ yaml_document_start_event_initialize(yaml_event_t *event,
             (tag_directives_start == tag_directives_end));
                             /* Valid tag directives are expected. */
 
+    context.allocator = NULL;
+
     if (version_directive) {
         version_directive_copy = yaml_malloc(sizeof(yaml_version_directive_t));
         if (!version_directive_copy) goto error;
@@ -755,12 +1551,12 @@ yaml_document_start_event_initialize(yaml_event_t *event,
 
 error:
     yaml_free(version_directive_copy);
-    while (!STACK_EMPTY(context, tag_directives_copy)) {
-        yaml_tag_directive_t value = POP(context, tag_directives_copy);
+    while (!STACK_EMPTY(&context, tag_directives_copy)) {
+        yaml_tag_directive_t value = POP(&context, tag_directives_copy);
         yaml_free(value.handle);
         yaml_free(value.prefix);
     }
-    STACK_DEL(context, tag_directives_copy);
+    STACK_DEL(&context, tag_directives_copy);
     yaml_free(value.handle);
     yaml_free(value.prefix);
 
@@ -982,37 +1778,56 @@ yaml_event_delete(yaml_event_t *event)
 
     assert(event);  /* Non-NULL event object expected. */
 
+    /* The strings in the arena of a parser are released with it. */
+
+    if (event->arena) {
+        if (event->type == YAML_DOCUMENT_START_EVENT) {
+            CONTEXT_FREE(event, event->data.document_start.version_directive);
+            CONTEXT_FREE(event, event->data.document_start.tag_directives.start);
+        }
+        memset(event, 0, sizeof(yaml_event_t));
+        return;
+    }
+
     switch (event->type)
     {
         case YAML_DOCUMENT_START_EVENT:
-            yaml_free(event->data.document_start.version_directive);
+            CONTEXT_FREE(event, event->data.document_start.version_directive);
             for (tag_directive = event->data.document_start.tag_directives.start;
                     tag_directive != event->data.document_start.tag_directives.end;
                     tag_directive++) {
-                yaml_free(tag_directive->handle);
-                yaml_free(tag_directive->prefix);
+                CONTEXT_FREE(event, tag_directive->handle);
+                CONTEXT_FREE(event, tag_directive->prefix);
             }
-            yaml_free(event->data.document_start.tag_directives.start);
+            CONTEXT_FREE(event, event->data.document_start.tag_directives.start);
             break;
 
         case YAML_ALIAS_EVENT:
-            yaml_free(event->data.alias.anchor);
+            CONTEXT_FREE(event, event->data.alias.anchor);
             break;
 
         case YAML_SCALAR_EVENT:
-            yaml_free(event->data.scalar.anchor);
-            yaml_free(event->data.scalar.tag);
-            yaml_free(event->data.scalar.value);
+            CONTEXT_FREE(event, event->data.scalar.anchor);
+            if (!event->data.scalar.tag_shared) {
+                CONTEXT_FREE(event, event->data.scalar.tag);
+            }
+            if (!event->data.scalar.borrowed) {
+                CONTEXT_FREE(event, event->data.scalar.value);
+            }
             break;
 
         case YAML_SEQUENCE_START_EVENT:
-            yaml_free(event->data.sequence_start.anchor);
-            yaml_free(event->data.sequence_start.tag);
+            CONTEXT_FREE(event, event->data.sequence_start.anchor);
+            if (!event->data.sequence_start.tag_shared) {
+                CONTEXT_FREE(event, event->data.sequence_start.tag);
+            }
             break;
 
         case YAML_MAPPING_START_EVENT:
-            yaml_free(event->data.mapping_start.anchor);
-            yaml_free(event->data.mapping_start.tag);
+            CONTEXT_FREE(event, event->data.mapping_start.anchor);
+            if (!event->data.mapping_start.tag_shared) {
+                CONTEXT_FREE(event, event->data.mapping_start.tag);
+            }
             break;
 
         default:
@@ -1035,6 +1850,7 @@ yaml_document_initialize(yaml_document_t *document,
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
     struct {
         yaml_node_t *start;
@@ -1055,6 +1871,8 @@ yaml_document_initialize(yaml_document_t *document,
             (tag_directives_start == tag_directives_end));
                             /* Valid tag directives are expected. */
 
+    context.allocator = NULL;
+
     if (!STACK_INIT(&context, nodes, INITIAL_STACK_SIZE)) goto error;
 
     if (version_directive) {
@@ -1118,6 +1936,7 @@ yaml_document_delete(yaml_document_t *document)
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
     yaml_tag_directive_t *tag_directive;
 
@@ -1125,12 +1944,14 @@ yaml_document_delete(yaml_document_t *document)
 
     assert(document);   /* Non-NULL document object is expected. */
 
+    context.allocator = document->allocator;
+
     while (!STACK_EMPTY(&context, document->nodes)) {
         yaml_node_t node = POP(&context, document->nodes);
-        yaml_free(node.tag);
+        CONTEXT_FREE(document, node.tag);
         switch (node.type) {
             case YAML_SCALAR_NODE:
-                yaml_free(node.data.scalar.value);
+                CONTEXT_FREE(document, node.data.scalar.value);
                 break;
             case YAML_SEQUENCE_NODE:
                 STACK_DEL(&context, node.data.sequence.items);
@@ -1144,14 +1965,14 @@ yaml_document_delete(yaml_document_t *document)
     }
     STACK_DEL(&context, document->nodes);
 
-    yaml_free(document->version_directive);
+    CONTEXT_FREE(document, document->version_directive);
     for (tag_directive = document->tag_directives.start;
             tag_directive != document->tag_directives.end;
             tag_directive++) {
-        yaml_free(tag_directive->handle);
-        yaml_free(tag_directive->prefix);
+        CONTEXT_FREE(document, tag_directive->handle);
+        CONTEXT_FREE(document, tag_directive->prefix);
     }
-    yaml_free(document->tag_directives.start);
+    CONTEXT_FREE(document, document->tag_directives.start);
 
     memset(document, 0, sizeof(yaml_document_t));
 }
@@ -1197,6 +2018,7 @@ yaml_document_add_scalar(yaml_document_t *document,
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
     yaml_mark_t mark = { 0, 0, 0 };
     yaml_char_t *tag_copy = NULL;
@@ -1206,12 +2028,14 @@ yaml_document_add_scalar(yaml_document_t *document,
     assert(document);   /* Non-NULL document object is expected. */
     assert(value);      /* Non-NULL value is expected. */
 
+    context.allocator = document->allocator;
+
     if (!tag) {
         tag = (yaml_char_t *)YAML_DEFAULT_SCALAR_TAG;
     }
 
     if (!yaml_check_utf8(tag, strlen((char *)tag))) goto error;
-    tag_copy = yaml_strdup(tag);
+    tag_copy = CONTEXT_STRDUP(document, tag);
     if (!tag_copy) goto error;
 
     if (length < 0) {
@@ -1219,7 +2043,7 @@ yaml_document_add_scalar(yaml_document_t *document,
     }
 
     if (!yaml_check_utf8(value, length)) goto error;
-    value_copy = yaml_malloc(length+1);
+    value_copy = CONTEXT_MALLOC(document, length+1);
     if (!value_copy) goto error;
     memcpy(value_copy, value, length);
     value_copy[length] = '\0';
@@ -1230,8 +2054,8 @@ yaml_document_add_scalar(yaml_document_t *document,
     return document->nodes.top - document->nodes.start;
 
 error:
-    yaml_free(tag_copy);
-    yaml_free(value_copy);
+    CONTEXT_FREE(document, tag_copy);
+    CONTEXT_FREE(document, value_copy);
 
     return 0;
 }
@@ -1246,6 +2070,7 @@ yaml_document_add_sequence(yaml_document_t *document,
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
     yaml_mark_t mark = { 0, 0, 0 };
     yaml_char_t *tag_copy = NULL;
@@ -1258,12 +2083,14 @@ yaml_document_add_sequence(yaml_document_t *document,
 
     assert(document);   /* Non-NULL document object is expected. */
 
+    context.allocator = document->allocator;
+
     if (!tag) {
         tag = (yaml_char_t *)YAML_DEFAULT_SEQUENCE_TAG;
     }
 
     if (!yaml_check_utf8(tag, strlen((char *)tag))) goto error;
-    tag_copy = yaml_strdup(tag);
+    tag_copy = CONTEXT_STRDUP(document, tag);
     if (!tag_copy) goto error;
 
     if (!STACK_INIT(&context, items, INITIAL_STACK_SIZE)) goto error;
@@ -1276,7 +2103,7 @@ yaml_document_add_sequence(yaml_document_t *document,
 
 error:
     STACK_DEL(&context, items);
-    yaml_free(tag_copy);
+    CONTEXT_FREE(document, tag_copy);
 
     return 0;
 }
@@ -1291,6 +2118,7 @@ yaml_document_add_mapping(yaml_document_t *document,
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
     yaml_mark_t mark = { 0, 0, 0 };
     yaml_char_t *tag_copy = NULL;
@@ -1303,12 +2131,14 @@ yaml_document_add_mapping(yaml_document_t *document,
 
     assert(document);   /* Non-NULL document object is expected. */
 
+    context.allocator = document->allocator;
+
     if (!tag) {
         tag = (yaml_char_t *)YAML_DEFAULT_MAPPING_TAG;
     }
 
     if (!yaml_check_utf8(tag, strlen((char *)tag))) goto error;
-    tag_copy = yaml_strdup(tag);
+    tag_copy = CONTEXT_STRDUP(document, tag);
     if (!tag_copy) goto error;
 
     if (!STACK_INIT(&context, pairs, INITIAL_STACK_SIZE)) goto error;
@@ -1321,7 +2151,7 @@ yaml_document_add_mapping(yaml_document_t *document,
 
 error:
     STACK_DEL(&context, pairs);
-    yaml_free(tag_copy);
+    CONTEXT_FREE(document, tag_copy);
 
     return 0;
 }
@@ -1336,6 +2166,7 @@ yaml_document_append_sequence_item(yaml_document_t *document,
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
 
     assert(document);       /* Non-NULL document is required. */
@@ -1347,6 +2178,8 @@ yaml_document_append_sequence_item(yaml_document_t *document,
     assert(item > 0 && document->nodes.start + item <= document->nodes.top);
                             /* Valid item id is required. */
 
+    context.allocator = document->allocator;
+
     if (!PUSH(&context,
                 document->nodes.start[sequence-1].data.sequence.items, item))
         return 0;
@@ -1364,6 +2197,7 @@ yaml_document_append_mapping_pair(yaml_document_t *document,
 {
     struct {
         yaml_error_type_t error;
+        const yaml_allocator_t *allocator;
     } context;
     yaml_node_pair_t pair = { key, value };
 
@@ -1378,6 +2212,8 @@ yaml_document_append_mapping_pair(yaml_document_t *document,
     assert(value > 0 && document->nodes.start + value <= document->nodes.top);
                             /* Valid value id is required. */
 
+    context.allocator = document->allocator;
+
     if (!PUSH(&context,
                 document->nodes.start[mapping-1].data.mapping.pairs, pair))
         return 0;
@@ -131,7 +131,7 @@ yaml_emitter_dump(yaml_emitter_t *emitter, yaml_document_t *document)
 
     assert(emitter->opened);    /* Emitter should be opened. */
 
-    emitter->anchors = yaml_malloc(sizeof(*(emitter->anchors))
+    emitter->anchors = CONTEXT_MALLOC(emitter, sizeof(*(emitter->anchors))
             * (document->nodes.top - document->nodes.start));
     if (!emitter->anchors) goto error;
     memset(emitter->anchors, 0, sizeof(*(emitter->anchors))
@@ -140,6 +140,7 @@ yaml_emitter_dump(yaml_emitter_t *emitter, yaml_document_t *document)
     DOCUMENT_START_EVENT_INIT(event, document->version_directive,
             document->tag_directives.start, document->tag_directives.end,
             document->start_implicit, mark, mark);
+    event.allocator = document->allocator;
     if (!yaml_emitter_emit(emitter, &event)) goto error;
 
     yaml_emitter_anchor_node(emitter, 1);
@@ -178,21 +179,21 @@ yaml_emitter_delete_document_and_anchors(yaml_emitter_t *emitter)
             < emitter->document->nodes.top; index ++) {
         yaml_node_t node = emitter->document->nodes.start[index];
         if (!emitter->anchors[index].serialized) {
-            yaml_free(node.tag);
+            CONTEXT_FREE(emitter->document, node.tag);
             if (node.type == YAML_SCALAR_NODE) {
-                yaml_free(node.data.scalar.value);
+                CONTEXT_FREE(emitter->document, node.data.scalar.value);
             }
         }
         if (node.type == YAML_SEQUENCE_NODE) {
-            STACK_DEL(emitter, node.data.sequence.items);
+            STACK_DEL(emitter->document, node.data.sequence.items);
         }
         if (node.type == YAML_MAPPING_NODE) {
-            STACK_DEL(emitter, node.data.mapping.pairs);
+            STACK_DEL(emitter->document, node.data.mapping.pairs);
         }
     }
 
-    STACK_DEL(emitter, emitter->document->nodes);
-    yaml_free(emitter->anchors);
+    STACK_DEL(emitter->document, emitter->document->nodes);
+    CONTEXT_FREE(emitter, emitter->anchors);
 
     emitter->anchors = NULL;
     emitter->last_anchor_id = 0;
@@ -247,7 +248,8 @@ yaml_emitter_anchor_node(yaml_emitter_t *emitter, int index)
 static yaml_char_t *
 yaml_emitter_generate_anchor(yaml_emitter_t *emitter, int anchor_id)
 {
-    yaml_char_t *anchor = yaml_malloc(ANCHOR_TEMPLATE_LENGTH);
+    yaml_char_t *anchor = CONTEXT_MALLOC(emitter->document,
+            ANCHOR_TEMPLATE_LENGTH);
 
     if (!anchor) return NULL;
 
@@ -304,6 +306,7 @@ yaml_emitter_dump_alias(yaml_emitter_t *emitter, yaml_char_t *anchor)
     yaml_mark_t mark  = { 0, 0, 0 };
 
     ALIAS_EVENT_INIT(event, anchor, mark, mark);
+    event.allocator = emitter->document->allocator;
 
     return yaml_emitter_emit(emitter, &event);
 }
@@ -327,6 +330,7 @@ yaml_emitter_dump_scalar(yaml_emitter_t *emitter, yaml_node_t *node,
     SCALAR_EVENT_INIT(event, anchor, node->tag, node->data.scalar.value,
             node->data.scalar.length, plain_implicit, quoted_implicit,
             node->data.scalar.style, mark, mark);
+    event.allocator = emitter->document->allocator;
 
     return yaml_emitter_emit(emitter, &event);
 }
@@ -348,6 +352,7 @@ yaml_emitter_dump_sequence(yaml_emitter_t *emitter, yaml_node_t *node,
 
     SEQUENCE_START_EVENT_INIT(event, anchor, node->tag, implicit,
             node->data.sequence.style, mark, mark);
+    event.allocator = emitter->document->allocator;
     if (!yaml_emitter_emit(emitter, &event)) return 0;
 
     for (item = node->data.sequence.items.start;
@@ -378,6 +383,7 @@ yaml_emitter_dump_mapping(yaml_emitter_t *emitter, yaml_node_t *node,
 
     MAPPING_START_EVENT_INIT(event, anchor, node->tag, implicit,
             node->data.mapping.style, mark, mark);
+    event.allocator = emitter->document->allocator;
     if (!yaml_emitter_emit(emitter, &event)) return 0;
 
     for (pair = node->data.mapping.pairs.start;
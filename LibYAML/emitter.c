@@ -286,9 +286,11 @@ yaml_emitter_emit(yaml_emitter_t *emitter, yaml_event_t *event)
     }
 
     while (!yaml_emitter_need_more_events(emitter)) {
-        if (!yaml_emitter_analyze_event(emitter, emitter->events.head))
+        if (!yaml_emitter_analyze_event(emitter,
+                    &QUEUE_AT(emitter, emitter->events, 0)))
             return 0;
-        if (!yaml_emitter_state_machine(emitter, emitter->events.head))
+        if (!yaml_emitter_state_machine(emitter,
+                    &QUEUE_AT(emitter, emitter->events, 0)))
             return 0;
         yaml_event_delete(&DEQUEUE(emitter, emitter->events));
     }
@@ -310,12 +312,12 @@ yaml_emitter_need_more_events(yaml_emitter_t *emitter)
 {
     int level = 0;
     int accumulate = 0;
-    yaml_event_t *event;
+    size_t index;
 
     if (QUEUE_EMPTY(emitter, emitter->events))
         return 1;
 
-    switch (emitter->events.head->type) {
+    switch (QUEUE_AT(emitter, emitter->events, 0).type) {
         case YAML_DOCUMENT_START_EVENT:
             accumulate = 1;
             break;
@@ -329,11 +331,11 @@ yaml_emitter_need_more_events(yaml_emitter_t *emitter)
             return 0;
     }
 
-    if (emitter->events.tail - emitter->events.head > accumulate)
+    if (QUEUE_LENGTH(emitter, emitter->events) > (size_t)accumulate)
         return 0;
 
-    for (event = emitter->events.head; event != emitter->events.tail; event ++) {
-        switch (event->type) {
+    for (index = 0; index < QUEUE_LENGTH(emitter, emitter->events); index ++) {
+        switch (QUEUE_AT(emitter, emitter->events, index).type) {
             case YAML_STREAM_START_EVENT:
             case YAML_DOCUMENT_START_EVENT:
             case YAML_SEQUENCE_START_EVENT:
@@ -377,8 +379,8 @@ yaml_emitter_append_tag_directive(yaml_emitter_t *emitter,
         }
     }
 
-    copy.handle = yaml_strdup(value.handle);
-    copy.prefix = yaml_strdup(value.prefix);
+    copy.handle = CONTEXT_STRDUP(emitter, value.handle);
+    copy.prefix = CONTEXT_STRDUP(emitter, value.prefix);
     if (!copy.handle || !copy.prefix) {
         emitter->error = YAML_MEMORY_ERROR;
         goto error;
@@ -390,8 +392,8 @@ yaml_emitter_append_tag_directive(yaml_emitter_t *emitter,
     return 1;
 
 error:
-    yaml_free(copy.handle);
-    yaml_free(copy.prefix);
+    CONTEXT_FREE(emitter, copy.handle);
+    CONTEXT_FREE(emitter, copy.prefix);
     return 0;
 }
 
@@ -497,6 +499,12 @@ yaml_emitter_emit_stream_start(yaml_emitter_t *emitter,
 {
     if (event->type == YAML_STREAM_START_EVENT)
     {
+        /* A reset emitter may have given its buffer back to the output. */
+
+        if (!emitter->buffer.start
+                && !BUFFER_INIT(emitter, emitter->buffer, emitter->buffer_size))
+            return 0;
+
         if (!emitter->encoding) {
             emitter->encoding = event->data.stream_start.encoding;
         }
@@ -690,8 +698,8 @@ yaml_emitter_emit_document_end(yaml_emitter_t *emitter,
         while (!STACK_EMPTY(emitter, emitter->tag_directives)) {
             yaml_tag_directive_t tag_directive = POP(emitter,
                     emitter->tag_directives);
-            yaml_free(tag_directive.handle);
-            yaml_free(tag_directive.prefix);
+            CONTEXT_FREE(emitter, tag_directive.handle);
+            CONTEXT_FREE(emitter, tag_directive.prefix);
         }
 
         return 1;
@@ -1080,11 +1088,13 @@ yaml_emitter_check_empty_document(yaml_emitter_t *emitter)
 static int
 yaml_emitter_check_empty_sequence(yaml_emitter_t *emitter)
 {
-    if (emitter->events.tail - emitter->events.head < 2)
+    if (QUEUE_LENGTH(emitter, emitter->events) < 2)
         return 0;
 
-    return (emitter->events.head[0].type == YAML_SEQUENCE_START_EVENT
-            && emitter->events.head[1].type == YAML_SEQUENCE_END_EVENT);
+    return (QUEUE_AT(emitter, emitter->events, 0).type
+                == YAML_SEQUENCE_START_EVENT
+            && QUEUE_AT(emitter, emitter->events, 1).type
+                == YAML_SEQUENCE_END_EVENT);
 }
 
 /*
@@ -1094,11 +1104,13 @@ yaml_emitter_check_empty_sequence(yaml_emitter_t *emitter)
 static int
 yaml_emitter_check_empty_mapping(yaml_emitter_t *emitter)
 {
-    if (emitter->events.tail - emitter->events.head < 2)
+    if (QUEUE_LENGTH(emitter, emitter->events) < 2)
         return 0;
 
-    return (emitter->events.head[0].type == YAML_MAPPING_START_EVENT
-            && emitter->events.head[1].type == YAML_MAPPING_END_EVENT);
+    return (QUEUE_AT(emitter, emitter->events, 0).type
+                == YAML_MAPPING_START_EVENT
+            && QUEUE_AT(emitter, emitter->events, 1).type
+                == YAML_MAPPING_END_EVENT);
 }
 
 /*
@@ -1108,7 +1120,7 @@ yaml_emitter_check_empty_mapping(yaml_emitter_t *emitter)
 static int
 yaml_emitter_check_simple_key(yaml_emitter_t *emitter)
 {
-    yaml_event_t *event = emitter->events.head;
+    yaml_event_t *event = &QUEUE_AT(emitter, emitter->events, 0);
     size_t length = 0;
 
     switch (event->type)
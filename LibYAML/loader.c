@@ -30,6 +30,12 @@ static int
 yaml_parser_register_anchor(yaml_parser_t *parser,
         int index, yaml_char_t *anchor);
 
+static yaml_alias_data_t *
+yaml_parser_find_alias(yaml_parser_t *parser, const yaml_char_t *anchor);
+
+static int
+yaml_parser_extend_aliases(yaml_parser_t *parser);
+
 /*
  * Clean up functions.
  */
@@ -47,6 +53,9 @@ yaml_parser_load_document(yaml_parser_t *parser, yaml_event_t *first_event);
 static int
 yaml_parser_load_node(yaml_parser_t *parser, yaml_event_t *first_event);
 
+static int
+yaml_parser_own_event(yaml_parser_t *parser, yaml_event_t *event);
+
 static int
 yaml_parser_load_alias(yaml_parser_t *parser, yaml_event_t *first_event);
 
@@ -72,6 +81,7 @@ yaml_parser_load(yaml_parser_t *parser, yaml_document_t *document)
     assert(document);   /* Non-NULL document object is expected. */
 
     memset(document, 0, sizeof(yaml_document_t));
+    document->allocator = parser->allocator;
     if (!STACK_INIT(parser, document->nodes, INITIAL_STACK_SIZE))
         goto error;
 
@@ -90,8 +100,15 @@ yaml_parser_load(yaml_parser_t *parser, yaml_document_t *document)
         return 1;
     }
 
-    if (!STACK_INIT(parser, parser->aliases, INITIAL_STACK_SIZE))
+    if (!(parser->aliases.start = CONTEXT_MALLOC(parser,
+                    INITIAL_STACK_SIZE*sizeof(yaml_alias_data_t)))) {
+        parser->error = YAML_MEMORY_ERROR;
         goto error;
+    }
+    memset(parser->aliases.start, 0,
+            INITIAL_STACK_SIZE*sizeof(yaml_alias_data_t));
+    parser->aliases.end = parser->aliases.start + INITIAL_STACK_SIZE;
+    parser->aliases.count = 0;
 
     parser->document = document;
 
@@ -145,16 +162,21 @@ yaml_parser_set_composer_error_context(yaml_parser_t *parser,
 }
 
 /*
- * Delete the stack of aliases.
+ * Delete the table of aliases.
  */
 
 static void
 yaml_parser_delete_aliases(yaml_parser_t *parser)
 {
-    while (!STACK_EMPTY(parser, parser->aliases)) {
-        yaml_free(POP(parser, parser->aliases).anchor);
+    yaml_alias_data_t *alias_data;
+
+    for (alias_data = parser->aliases.start;
+            alias_data != parser->aliases.end; alias_data ++) {
+        CONTEXT_FREE(parser, alias_data->anchor);
     }
-    STACK_DEL(parser, parser->aliases);
+    CONTEXT_FREE(parser, parser->aliases.start);
+    parser->aliases.start = parser->aliases.end = NULL;
+    parser->aliases.count = 0;
 }
 
 /*
@@ -169,6 +191,8 @@ yaml_parser_load_document(yaml_parser_t *parser, yaml_event_t *first_event)
     assert(first_event->type == YAML_DOCUMENT_START_EVENT);
                         /* DOCUMENT-START is expected. */
 
+    if (!yaml_parser_own_event(parser, first_event)) return 0;
+
     parser->document->version_directive
         = first_event->data.document_start.version_directive;
     parser->document->tag_directives.start
@@ -200,6 +224,9 @@ yaml_parser_load_document(yaml_parser_t *parser, yaml_event_t *first_event)
 static int
 yaml_parser_load_node(yaml_parser_t *parser, yaml_event_t *first_event)
 {
+    if (!yaml_parser_own_event(parser, first_event))
+        return 0;
+
     switch (first_event->type) {
         case YAML_ALIAS_EVENT:
             return yaml_parser_load_alias(parser, first_event);
@@ -217,6 +244,169 @@ yaml_parser_load_node(yaml_parser_t *parser, yaml_event_t *first_event)
     return 0;
 }
 
+/*
+ * Make an event own its strings, which its document or node takes over.  The
+ * value of a scalar may be borrowed from the input, a tag may be shared by
+ * the events of the document, and every string may live in the arena of the
+ * parser.
+ */
+
+static int
+yaml_parser_own_event(yaml_parser_t *parser, yaml_event_t *event)
+{
+    yaml_char_t **anchor_ref = NULL;
+    yaml_char_t **tag_ref = NULL;
+    int *tag_shared_ref = NULL;
+    yaml_char_t *anchor = NULL;
+    yaml_char_t *tag = NULL;
+    yaml_char_t *value = NULL;
+    int copy_tag, copy_value = 0;
+
+    switch (event->type) {
+        case YAML_DOCUMENT_START_EVENT:
+            if (event->arena) {
+                yaml_tag_directive_t *tag_directive;
+                int failed = 0;
+                event->arena = 0;
+                for (tag_directive = event->data.document_start.tag_directives.start;
+                        tag_directive != event->data.document_start.tag_directives.end;
+                        tag_directive ++) {
+                    tag_directive->handle =
+                        CONTEXT_STRDUP(parser, tag_directive->handle);
+                    tag_directive->prefix =
+                        CONTEXT_STRDUP(parser, tag_directive->prefix);
+                    failed |= !tag_directive->handle || !tag_directive->prefix;
+                }
+                if (failed) {
+                    parser->error = YAML_MEMORY_ERROR;
+                    yaml_event_delete(event);
+                    return 0;
+                }
+            }
+            return 1;
+        case YAML_ALIAS_EVENT:
+            anchor_ref = &event->data.alias.anchor;
+            break;
+        case YAML_SCALAR_EVENT:
+            anchor_ref = &event->data.scalar.anchor;
+            tag_ref = &event->data.scalar.tag;
+            tag_shared_ref = &event->data.scalar.tag_shared;
+            copy_value = event->arena || event->data.scalar.borrowed;
+            break;
+        case YAML_SEQUENCE_START_EVENT:
+            anchor_ref = &event->data.sequence_start.anchor;
+            tag_ref = &event->data.sequence_start.tag;
+            tag_shared_ref = &event->data.sequence_start.tag_shared;
+            break;
+        case YAML_MAPPING_START_EVENT:
+            anchor_ref = &event->data.mapping_start.anchor;
+            tag_ref = &event->data.mapping_start.tag;
+            tag_shared_ref = &event->data.mapping_start.tag_shared;
+            break;
+        default:
+            return 1;
+    }
+
+    copy_tag = tag_ref && (event->arena || *tag_shared_ref);
+
+    if (event->arena && *anchor_ref
+            && !(anchor = CONTEXT_STRDUP(parser, *anchor_ref)))
+        goto error;
+    if (copy_tag && *tag_ref && !(tag = CONTEXT_STRDUP(parser, *tag_ref)))
+        goto error;
+    if (copy_value) {
+        size_t length = event->data.scalar.length;
+        if (!(value = CONTEXT_MALLOC(parser, length+1)))
+            goto error;
+        memcpy(value, event->data.scalar.value, length);
+        value[length] = '\0';
+    }
+
+    if (event->arena) {
+        *anchor_ref = anchor;
+        event->arena = 0;
+    }
+    if (copy_tag) {
+        *tag_ref = tag;
+        *tag_shared_ref = 0;
+    }
+    if (copy_value) {
+        event->data.scalar.value = value;
+        event->data.scalar.borrowed = 0;
+    }
+
+    return 1;
+
+error:
+    CONTEXT_FREE(parser, anchor);
+    CONTEXT_FREE(parser, tag);
+    parser->error = YAML_MEMORY_ERROR;
+    yaml_event_delete(event);
+    return 0;
+}
+
+/*
+ * Find the slot of an anchor in the table of aliases: the slot that holds the
+ * anchor, or the empty slot where it belongs.
+ *
+ * The table is probed linearly from the FNV-1a hash of the anchor.  It is
+ * kept at most half full, so there is always an empty slot.
+ */
+
+static yaml_alias_data_t *
+yaml_parser_find_alias(yaml_parser_t *parser, const yaml_char_t *anchor)
+{
+    size_t mask = (parser->aliases.end - parser->aliases.start) - 1;
+    size_t hash = 2166136261u;
+    const yaml_char_t *pointer;
+    yaml_alias_data_t *alias_data;
+
+    for (pointer = anchor; *pointer; pointer ++) {
+        hash = (hash ^ *pointer) * 16777619u;
+    }
+
+    alias_data = parser->aliases.start + (hash & mask);
+
+    while (alias_data->anchor
+            && strcmp((char *)alias_data->anchor, (char *)anchor) != 0) {
+        alias_data = parser->aliases.start
+            + ((alias_data - parser->aliases.start + 1) & mask);
+    }
+
+    return alias_data;
+}
+
+/*
+ * Double the table of aliases.
+ */
+
+static int
+yaml_parser_extend_aliases(yaml_parser_t *parser)
+{
+    yaml_alias_data_t *start = parser->aliases.start;
+    yaml_alias_data_t *end = parser->aliases.end;
+    size_t size = (end - start)*2;
+    yaml_alias_data_t *alias_data;
+
+    if (!(parser->aliases.start = CONTEXT_MALLOC(parser,
+                    size*sizeof(yaml_alias_data_t)))) {
+        parser->aliases.start = start;
+        parser->error = YAML_MEMORY_ERROR;
+        return 0;
+    }
+    memset(parser->aliases.start, 0, size*sizeof(yaml_alias_data_t));
+    parser->aliases.end = parser->aliases.start + size;
+
+    for (alias_data = start; alias_data != end; alias_data ++) {
+        if (alias_data->anchor) {
+            *yaml_parser_find_alias(parser, alias_data->anchor) = *alias_data;
+        }
+    }
+    CONTEXT_FREE(parser, start);
+
+    return 1;
+}
+
 /*
  * Add an anchor.
  */
@@ -232,21 +422,25 @@ yaml_parser_register_anchor(yaml_parser_t *parser,
 
     data.mark = parser->document->nodes.start[index-1].start_mark;
 
-    for (alias_data = parser->aliases.start;
-            alias_data != parser->aliases.top; alias_data ++) {
-        if (strcmp((char *)alias_data->anchor, (char *)anchor) == 0) {
-            yaml_free(anchor);
-            return yaml_parser_set_composer_error_context(parser,
-                    "found duplicate anchor; first occurence",
-                    alias_data->mark, "second occurence", data.mark);
-        }
+    if ((parser->aliases.count+1)*2
+            > (size_t)(parser->aliases.end - parser->aliases.start)
+            && !yaml_parser_extend_aliases(parser)) {
+        CONTEXT_FREE(parser, anchor);
+        return 0;
     }
 
-    if (!PUSH(parser, parser->aliases, data)) {
-        yaml_free(anchor);
-        return 0;
+    alias_data = yaml_parser_find_alias(parser, anchor);
+
+    if (alias_data->anchor) {
+        CONTEXT_FREE(parser, anchor);
+        return yaml_parser_set_composer_error_context(parser,
+                "found duplicate anchor; first occurence",
+                alias_data->mark, "second occurence", data.mark);
     }
 
+    *alias_data = data;
+    parser->aliases.count ++;
+
     return 1;
 }
 
@@ -258,17 +452,13 @@ static int
 yaml_parser_load_alias(yaml_parser_t *parser, yaml_event_t *first_event)
 {
     yaml_char_t *anchor = first_event->data.alias.anchor;
-    yaml_alias_data_t *alias_data;
+    yaml_alias_data_t *alias_data = yaml_parser_find_alias(parser, anchor);
 
-    for (alias_data = parser->aliases.start;
-            alias_data != parser->aliases.top; alias_data ++) {
-        if (strcmp((char *)alias_data->anchor, (char *)anchor) == 0) {
-            yaml_free(anchor);
-            return alias_data->index;
-        }
-    }
+    CONTEXT_FREE(parser, anchor);
+
+    if (alias_data->anchor)
+        return alias_data->index;
 
-    yaml_free(anchor);
     return yaml_parser_set_composer_error(parser, "found undefined alias",
             first_event->start_mark);
 }
@@ -285,8 +475,8 @@ yaml_parser_load_scalar(yaml_parser_t *parser, yaml_event_t *first_event)
     yaml_char_t *tag = first_event->data.scalar.tag;
 
     if (!tag || strcmp((char *)tag, "!") == 0) {
-        yaml_free(tag);
-        tag = yaml_strdup((yaml_char_t *)YAML_DEFAULT_SCALAR_TAG);
+        CONTEXT_FREE(parser, tag);
+        tag = CONTEXT_STRDUP(parser, (yaml_char_t *)YAML_DEFAULT_SCALAR_TAG);
         if (!tag) goto error;
     }
 
@@ -304,9 +494,9 @@ yaml_parser_load_scalar(yaml_parser_t *parser, yaml_event_t *first_event)
     return index;
 
 error:
-    yaml_free(tag);
-    yaml_free(first_event->data.scalar.anchor);
-    yaml_free(first_event->data.scalar.value);
+    CONTEXT_FREE(parser, tag);
+    CONTEXT_FREE(parser, first_event->data.scalar.anchor);
+    CONTEXT_FREE(parser, first_event->data.scalar.value);
     return 0;
 }
 
@@ -328,8 +518,8 @@ yaml_parser_load_sequence(yaml_parser_t *parser, yaml_event_t *first_event)
     yaml_char_t *tag = first_event->data.sequence_start.tag;
 
     if (!tag || strcmp((char *)tag, "!") == 0) {
-        yaml_free(tag);
-        tag = yaml_strdup((yaml_char_t *)YAML_DEFAULT_SEQUENCE_TAG);
+        CONTEXT_FREE(parser, tag);
+        tag = CONTEXT_STRDUP(parser, (yaml_char_t *)YAML_DEFAULT_SEQUENCE_TAG);
         if (!tag) goto error;
     }
 
@@ -362,8 +552,8 @@ yaml_parser_load_sequence(yaml_parser_t *parser, yaml_event_t *first_event)
     return index;
 
 error:
-    yaml_free(tag);
-    yaml_free(first_event->data.sequence_start.anchor);
+    CONTEXT_FREE(parser, tag);
+    CONTEXT_FREE(parser, first_event->data.sequence_start.anchor);
     return 0;
 }
 
@@ -386,8 +576,8 @@ yaml_parser_load_mapping(yaml_parser_t *parser, yaml_event_t *first_event)
     yaml_char_t *tag = first_event->data.mapping_start.tag;
 
     if (!tag || strcmp((char *)tag, "!") == 0) {
-        yaml_free(tag);
-        tag = yaml_strdup((yaml_char_t *)YAML_DEFAULT_MAPPING_TAG);
+        CONTEXT_FREE(parser, tag);
+        tag = CONTEXT_STRDUP(parser, (yaml_char_t *)YAML_DEFAULT_MAPPING_TAG);
         if (!tag) goto error;
     }
 
@@ -423,8 +613,8 @@ yaml_parser_load_mapping(yaml_parser_t *parser, yaml_event_t *first_event)
     return index;
 
 error:
-    yaml_free(tag);
-    yaml_free(first_event->data.mapping_start.anchor);
+    CONTEXT_FREE(parser, tag);
+    CONTEXT_FREE(parser, first_event->data.mapping_start.anchor);
     return 0;
 }
 
@@ -47,7 +47,7 @@
 
 #define PEEK_TOKEN(parser)                                                      \
     ((parser->token_available || yaml_parser_fetch_more_tokens(parser)) ?       \
-        parser->tokens.head : NULL)
+        &QUEUE_AT(parser, parser->tokens, 0) : NULL)
 
 /*
  * Remove the next token from the queue (must be called after PEEK_TOKEN).
@@ -57,9 +57,17 @@
     (parser->token_available = 0,                                               \
      parser->tokens_parsed ++,                                                  \
      parser->stream_end_produced =                                              \
-        (parser->tokens.head->type == YAML_STREAM_END_TOKEN),                   \
+        (QUEUE_AT(parser, parser->tokens, 0).type == YAML_STREAM_END_TOKEN),    \
      parser->tokens.head ++)
 
+/*
+ * Get the type of a queued token, or YAML_NO_TOKEN if it is not scanned yet.
+ */
+
+#define TOKEN_TYPE_AT(parser,index)                                             \
+    ((index) < QUEUE_LENGTH(parser, parser->tokens) ?                           \
+        QUEUE_AT(parser, parser->tokens, index).type : YAML_NO_TOKEN)
+
 /*
  * Public API declarations.
  */
@@ -144,6 +152,9 @@ static int
 yaml_parser_parse_flow_mapping_value(yaml_parser_t *parser,
         yaml_event_t *event, int empty);
 
+static size_t
+yaml_parser_node_lookahead(yaml_parser_t *parser, size_t index);
+
 /*
  * Utility functions.
  */
@@ -162,6 +173,16 @@ static int
 yaml_parser_append_tag_directive(yaml_parser_t *parser,
         yaml_tag_directive_t value, int allow_duplicates, yaml_mark_t mark);
 
+static yaml_tag_data_t *
+yaml_parser_find_tag(yaml_parser_t *parser,
+        const yaml_char_t *handle, const yaml_char_t *suffix);
+
+static void
+yaml_parser_release_arena(yaml_parser_t *parser);
+
+static int
+yaml_parser_add_tag(yaml_parser_t *parser, yaml_tag_data_t value);
+
 /*
  * Get the next event.
  */
@@ -183,9 +204,59 @@ yaml_parser_parse(yaml_parser_t *parser, yaml_event_t *event)
         return 1;
     }
 
+    /* With a pushed input, ensure that the event is complete in advance. */
+
+    if (parser->input_needed || (!parser->read_handler && !parser->push)) {
+        parser->input_needed = 1;
+        return 1;
+    }
+    if (parser->push) {
+        if (!yaml_parser_fetch_event_tokens(parser))
+            return parser->input_needed;
+    }
+
     /* Generate the next event. */
 
-    return yaml_parser_state_machine(parser, event);
+    if (!yaml_parser_state_machine(parser, event))
+        return 0;
+
+    event->arena = ARENA_USED(parser);
+    event->allocator = parser->allocator;
+
+    return 1;
+}
+
+/*
+ * Get the next events up to the end of a document.
+ */
+
+YAML_DECLARE(int)
+yaml_parser_parse_batch(yaml_parser_t *parser, yaml_event_t *events,
+        size_t size, size_t *count)
+{
+    assert(parser);     /* Non-NULL parser object is expected. */
+    assert(events || !size);    /* Non-NULL events array is expected. */
+    assert(count);      /* Non-NULL count is expected. */
+
+    *count = 0;
+
+    while (*count < size)
+    {
+        yaml_event_t *event = events + *count;
+
+        if (!yaml_parser_parse(parser, event))
+            return 0;
+        if (event->type == YAML_NO_EVENT)
+            break;
+
+        (*count) ++;
+
+        if (event->type == YAML_DOCUMENT_END_EVENT
+                || event->type == YAML_STREAM_END_EVENT)
+            break;
+    }
+
+    return 1;
 }
 
 /*
@@ -303,6 +374,184 @@ yaml_parser_state_machine(yaml_parser_t *parser, yaml_event_t *event)
     return 0;
 }
 
+/*
+ * Get the number of tokens the state machine looks at to produce the next
+ * event.
+ *
+ * The tokens are counted the way the state functions peek and skip them.  A
+ * token that is not scanned yet counts as well, so the result exceeds the
+ * length of the queue until the event can be produced without running out of
+ * tokens.
+ */
+
+YAML_DECLARE(size_t)
+yaml_parser_event_lookahead(yaml_parser_t *parser)
+{
+    size_t index = 0;
+    yaml_token_type_t type;
+
+    switch (parser->state)
+    {
+        case YAML_PARSE_DOCUMENT_START_STATE:
+            while (TOKEN_TYPE_AT(parser, index) == YAML_DOCUMENT_END_TOKEN) {
+                index ++;
+            }
+            /* Fall through. */
+
+        case YAML_PARSE_IMPLICIT_DOCUMENT_START_STATE:
+            while ((type = TOKEN_TYPE_AT(parser, index))
+                        == YAML_VERSION_DIRECTIVE_TOKEN
+                    || type == YAML_TAG_DIRECTIVE_TOKEN) {
+                index ++;
+            }
+            return index+1;
+
+        case YAML_PARSE_DOCUMENT_CONTENT_STATE:
+            type = TOKEN_TYPE_AT(parser, 0);
+            if (type == YAML_VERSION_DIRECTIVE_TOKEN ||
+                    type == YAML_TAG_DIRECTIVE_TOKEN ||
+                    type == YAML_DOCUMENT_START_TOKEN ||
+                    type == YAML_DOCUMENT_END_TOKEN ||
+                    type == YAML_STREAM_END_TOKEN)
+                return 1;
+            return yaml_parser_node_lookahead(parser, 0);
+
+        case YAML_PARSE_BLOCK_NODE_STATE:
+        case YAML_PARSE_BLOCK_NODE_OR_INDENTLESS_SEQUENCE_STATE:
+        case YAML_PARSE_FLOW_NODE_STATE:
+            return yaml_parser_node_lookahead(parser, 0);
+
+        case YAML_PARSE_BLOCK_SEQUENCE_FIRST_ENTRY_STATE:
+            index = 1;
+            /* Fall through. */
+
+        case YAML_PARSE_BLOCK_SEQUENCE_ENTRY_STATE:
+            if (TOKEN_TYPE_AT(parser, index) != YAML_BLOCK_ENTRY_TOKEN)
+                return index+1;
+            type = TOKEN_TYPE_AT(parser, index+1);
+            if (type == YAML_BLOCK_ENTRY_TOKEN || type == YAML_BLOCK_END_TOKEN)
+                return index+2;
+            return yaml_parser_node_lookahead(parser, index+1);
+
+        case YAML_PARSE_INDENTLESS_SEQUENCE_ENTRY_STATE:
+            if (TOKEN_TYPE_AT(parser, 0) != YAML_BLOCK_ENTRY_TOKEN)
+                return 1;
+            type = TOKEN_TYPE_AT(parser, 1);
+            if (type == YAML_BLOCK_ENTRY_TOKEN || type == YAML_KEY_TOKEN ||
+                    type == YAML_VALUE_TOKEN || type == YAML_BLOCK_END_TOKEN)
+                return 2;
+            return yaml_parser_node_lookahead(parser, 1);
+
+        case YAML_PARSE_BLOCK_MAPPING_FIRST_KEY_STATE:
+            index = 1;
+            /* Fall through. */
+
+        case YAML_PARSE_BLOCK_MAPPING_KEY_STATE:
+            if (TOKEN_TYPE_AT(parser, index) != YAML_KEY_TOKEN)
+                return index+1;
+            type = TOKEN_TYPE_AT(parser, index+1);
+            if (type == YAML_KEY_TOKEN || type == YAML_VALUE_TOKEN ||
+                    type == YAML_BLOCK_END_TOKEN)
+                return index+2;
+            return yaml_parser_node_lookahead(parser, index+1);
+
+        case YAML_PARSE_BLOCK_MAPPING_VALUE_STATE:
+            if (TOKEN_TYPE_AT(parser, 0) != YAML_VALUE_TOKEN)
+                return 1;
+            type = TOKEN_TYPE_AT(parser, 1);
+            if (type == YAML_KEY_TOKEN || type == YAML_VALUE_TOKEN ||
+                    type == YAML_BLOCK_END_TOKEN)
+                return 2;
+            return yaml_parser_node_lookahead(parser, 1);
+
+        case YAML_PARSE_FLOW_SEQUENCE_FIRST_ENTRY_STATE:
+        case YAML_PARSE_FLOW_SEQUENCE_ENTRY_STATE:
+            if (parser->state == YAML_PARSE_FLOW_SEQUENCE_FIRST_ENTRY_STATE) {
+                index = 1;
+            }
+            else if (TOKEN_TYPE_AT(parser, 0) == YAML_FLOW_ENTRY_TOKEN) {
+                index = 1;
+            }
+            else {
+                return 1;
+            }
+            type = TOKEN_TYPE_AT(parser, index);
+            if (type == YAML_KEY_TOKEN || type == YAML_FLOW_SEQUENCE_END_TOKEN)
+                return index+1;
+            return yaml_parser_node_lookahead(parser, index);
+
+        case YAML_PARSE_FLOW_SEQUENCE_ENTRY_MAPPING_KEY_STATE:
+            type = TOKEN_TYPE_AT(parser, 0);
+            if (type == YAML_VALUE_TOKEN || type == YAML_FLOW_ENTRY_TOKEN ||
+                    type == YAML_FLOW_SEQUENCE_END_TOKEN)
+                return 1;
+            return yaml_parser_node_lookahead(parser, 0);
+
+        case YAML_PARSE_FLOW_SEQUENCE_ENTRY_MAPPING_VALUE_STATE:
+            if (TOKEN_TYPE_AT(parser, 0) != YAML_VALUE_TOKEN)
+                return 1;
+            type = TOKEN_TYPE_AT(parser, 1);
+            if (type == YAML_FLOW_ENTRY_TOKEN ||
+                    type == YAML_FLOW_SEQUENCE_END_TOKEN)
+                return 2;
+            return yaml_parser_node_lookahead(parser, 1);
+
+        case YAML_PARSE_FLOW_MAPPING_FIRST_KEY_STATE:
+        case YAML_PARSE_FLOW_MAPPING_KEY_STATE:
+            if (parser->state == YAML_PARSE_FLOW_MAPPING_FIRST_KEY_STATE) {
+                index = 1;
+            }
+            else if (TOKEN_TYPE_AT(parser, 0) == YAML_FLOW_ENTRY_TOKEN) {
+                index = 1;
+            }
+            else {
+                return 1;
+            }
+            type = TOKEN_TYPE_AT(parser, index);
+            if (type == YAML_FLOW_MAPPING_END_TOKEN)
+                return index+1;
+            if (type == YAML_KEY_TOKEN) {
+                type = TOKEN_TYPE_AT(parser, index+1);
+                if (type == YAML_VALUE_TOKEN || type == YAML_FLOW_ENTRY_TOKEN ||
+                        type == YAML_FLOW_MAPPING_END_TOKEN)
+                    return index+2;
+                return yaml_parser_node_lookahead(parser, index+1);
+            }
+            return yaml_parser_node_lookahead(parser, index);
+
+        case YAML_PARSE_FLOW_MAPPING_VALUE_STATE:
+            if (TOKEN_TYPE_AT(parser, 0) != YAML_VALUE_TOKEN)
+                return 1;
+            type = TOKEN_TYPE_AT(parser, 1);
+            if (type == YAML_FLOW_ENTRY_TOKEN ||
+                    type == YAML_FLOW_MAPPING_END_TOKEN)
+                return 2;
+            return yaml_parser_node_lookahead(parser, 1);
+
+        default:
+            return 1;
+    }
+}
+
+/*
+ * Get the number of tokens up to the end of the node starting at the index,
+ * that is, the ANCHOR and TAG properties and the content token.
+ */
+
+static size_t
+yaml_parser_node_lookahead(yaml_parser_t *parser, size_t index)
+{
+    yaml_token_type_t type = TOKEN_TYPE_AT(parser, index);
+
+    if (type == YAML_ANCHOR_TOKEN || type == YAML_TAG_TOKEN) {
+        yaml_token_type_t next = TOKEN_TYPE_AT(parser, index+1);
+        index += ((next == YAML_ANCHOR_TOKEN || next == YAML_TAG_TOKEN)
+                && next != type) ? 2 : 1;
+    }
+
+    return index+1;
+}
+
 /*
  * Parse the production:
  * stream   ::= STREAM-START implicit_document? explicit_document* STREAM-END
@@ -349,6 +598,16 @@ yaml_parser_parse_document_start(yaml_parser_t *parser, yaml_event_t *event,
         yaml_tag_directive_t *end;
     } tag_directives = { NULL, NULL };
 
+    /*
+     * Forget the previous document.  It is done here rather than with its
+     * DOCUMENT-END event, so the strings of its events last until then.
+     */
+
+    yaml_parser_delete_tag_directives(parser);
+    if (ARENA_USED(parser)) {
+        yaml_parser_release_arena(parser);
+    }
+
     token = PEEK_TOKEN(parser);
     if (!token) return 0;
 
@@ -420,13 +679,13 @@ yaml_parser_parse_document_start(yaml_parser_t *parser, yaml_event_t *event,
     }
 
 error:
-    yaml_free(version_directive);
+    CONTEXT_FREE(parser, version_directive);
     while (tag_directives.start != tag_directives.end) {
-        yaml_free(tag_directives.end[-1].handle);
-        yaml_free(tag_directives.end[-1].prefix);
+        ARENA_FREE(parser, tag_directives.end[-1].handle);
+        ARENA_FREE(parser, tag_directives.end[-1].prefix);
         tag_directives.end --;
     }
-    yaml_free(tag_directives.start);
+    CONTEXT_FREE(parser, tag_directives.start);
     return 0;
 }
 
@@ -484,12 +743,6 @@ yaml_parser_parse_document_end(yaml_parser_t *parser, yaml_event_t *event)
         implicit = 0;
     }
 
-    while (!STACK_EMPTY(parser, parser->tag_directives)) {
-        yaml_tag_directive_t tag_directive = POP(parser, parser->tag_directives);
-        yaml_free(tag_directive.handle);
-        yaml_free(tag_directive.prefix);
-    }
-
     parser->state = YAML_PARSE_DOCUMENT_START_STATE;
     DOCUMENT_END_EVENT_INIT(*event, implicit, start_mark, end_mark);
 
@@ -535,6 +788,7 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
     yaml_char_t *tag_suffix = NULL;
     yaml_char_t *tag = NULL;
     yaml_mark_t start_mark, end_mark, tag_mark;
+    int tag_shared = 0;
     int implicit;
 
     token = PEEK_TOKEN(parser);
@@ -594,37 +848,48 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
         if (tag_handle) {
             if (!*tag_handle) {
                 tag = tag_suffix;
-                yaml_free(tag_handle);
+                ARENA_FREE(parser, tag_handle);
+                tag_handle = tag_suffix = NULL;
+            }
+            else if (parser->share_tags
+                    && (tag = yaml_parser_find_tag(parser,
+                            tag_handle, tag_suffix)->tag)) {
+                tag_shared = 1;
+                ARENA_FREE(parser, tag_handle);
+                ARENA_FREE(parser, tag_suffix);
                 tag_handle = tag_suffix = NULL;
             }
             else {
-                yaml_tag_directive_t *tag_directive;
-                for (tag_directive = parser->tag_directives.start;
-                        tag_directive != parser->tag_directives.top;
-                        tag_directive ++) {
-                    if (strcmp((char *)tag_directive->handle, (char *)tag_handle) == 0) {
-                        size_t prefix_len = strlen((char *)tag_directive->prefix);
-                        size_t suffix_len = strlen((char *)tag_suffix);
-                        tag = yaml_malloc(prefix_len+suffix_len+1);
-                        if (!tag) {
-                            parser->error = YAML_MEMORY_ERROR;
-                            goto error;
-                        }
-                        memcpy(tag, tag_directive->prefix, prefix_len);
-                        memcpy(tag+prefix_len, tag_suffix, suffix_len);
-                        tag[prefix_len+suffix_len] = '\0';
-                        yaml_free(tag_handle);
-                        yaml_free(tag_suffix);
-                        tag_handle = tag_suffix = NULL;
-                        break;
-                    }
-                }
-                if (!tag) {
+                yaml_char_t *prefix = yaml_parser_find_tag(parser,
+                        tag_handle, NULL)->tag;
+                size_t prefix_len, suffix_len;
+                if (!prefix) {
                     yaml_parser_set_parser_error_context(parser,
                             "while parsing a node", start_mark,
                             "found undefined tag handle", tag_mark);
                     goto error;
                 }
+                prefix_len = strlen((char *)prefix);
+                suffix_len = strlen((char *)tag_suffix);
+                tag = ARENA_MALLOC(parser, prefix_len+suffix_len+1);
+                if (!tag) {
+                    parser->error = YAML_MEMORY_ERROR;
+                    goto error;
+                }
+                memcpy(tag, prefix, prefix_len);
+                memcpy(tag+prefix_len, tag_suffix, suffix_len);
+                tag[prefix_len+suffix_len] = '\0';
+                if (parser->share_tags) {
+                    yaml_tag_data_t value = { tag_handle, tag_suffix, tag };
+                    if (!yaml_parser_add_tag(parser, value))
+                        goto error;
+                    tag_shared = 1;
+                }
+                else {
+                    ARENA_FREE(parser, tag_handle);
+                    ARENA_FREE(parser, tag_suffix);
+                }
+                tag_handle = tag_suffix = NULL;
             }
         }
 
@@ -634,6 +899,7 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
             parser->state = YAML_PARSE_INDENTLESS_SEQUENCE_ENTRY_STATE;
             SEQUENCE_START_EVENT_INIT(*event, anchor, tag, implicit,
                     YAML_BLOCK_SEQUENCE_STYLE, start_mark, end_mark);
+            event->data.sequence_start.tag_shared = tag_shared;
             return 1;
         }
         else {
@@ -653,6 +919,8 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
                         token->data.scalar.value, token->data.scalar.length,
                         plain_implicit, quoted_implicit,
                         token->data.scalar.style, start_mark, end_mark);
+                event->data.scalar.borrowed = token->data.scalar.borrowed;
+                event->data.scalar.tag_shared = tag_shared;
                 SKIP_TOKEN(parser);
                 return 1;
             }
@@ -661,6 +929,7 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
                 parser->state = YAML_PARSE_FLOW_SEQUENCE_FIRST_ENTRY_STATE;
                 SEQUENCE_START_EVENT_INIT(*event, anchor, tag, implicit,
                         YAML_FLOW_SEQUENCE_STYLE, start_mark, end_mark);
+                event->data.sequence_start.tag_shared = tag_shared;
                 return 1;
             }
             else if (token->type == YAML_FLOW_MAPPING_START_TOKEN) {
@@ -668,6 +937,7 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
                 parser->state = YAML_PARSE_FLOW_MAPPING_FIRST_KEY_STATE;
                 MAPPING_START_EVENT_INIT(*event, anchor, tag, implicit,
                         YAML_FLOW_MAPPING_STYLE, start_mark, end_mark);
+                event->data.mapping_start.tag_shared = tag_shared;
                 return 1;
             }
             else if (block && token->type == YAML_BLOCK_SEQUENCE_START_TOKEN) {
@@ -675,6 +945,7 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
                 parser->state = YAML_PARSE_BLOCK_SEQUENCE_FIRST_ENTRY_STATE;
                 SEQUENCE_START_EVENT_INIT(*event, anchor, tag, implicit,
                         YAML_BLOCK_SEQUENCE_STYLE, start_mark, end_mark);
+                event->data.sequence_start.tag_shared = tag_shared;
                 return 1;
             }
             else if (block && token->type == YAML_BLOCK_MAPPING_START_TOKEN) {
@@ -682,10 +953,11 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
                 parser->state = YAML_PARSE_BLOCK_MAPPING_FIRST_KEY_STATE;
                 MAPPING_START_EVENT_INIT(*event, anchor, tag, implicit,
                         YAML_BLOCK_MAPPING_STYLE, start_mark, end_mark);
+                event->data.mapping_start.tag_shared = tag_shared;
                 return 1;
             }
             else if (anchor || tag) {
-                yaml_char_t *value = yaml_malloc(1);
+                yaml_char_t *value = ARENA_MALLOC(parser, 1);
                 if (!value) {
                     parser->error = YAML_MEMORY_ERROR;
                     goto error;
@@ -695,6 +967,7 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
                 SCALAR_EVENT_INIT(*event, anchor, tag, value, 0,
                         implicit, 0, YAML_PLAIN_SCALAR_STYLE,
                         start_mark, end_mark);
+                event->data.scalar.tag_shared = tag_shared;
                 return 1;
             }
             else {
@@ -708,10 +981,12 @@ yaml_parser_parse_node(yaml_parser_t *parser, yaml_event_t *event,
     }
 
 error:
-    yaml_free(anchor);
-    yaml_free(tag_handle);
-    yaml_free(tag_suffix);
-    yaml_free(tag);
+    ARENA_FREE(parser, anchor);
+    ARENA_FREE(parser, tag_handle);
+    ARENA_FREE(parser, tag_suffix);
+    if (!tag_shared) {
+        ARENA_FREE(parser, tag);
+    }
 
     return 0;
 }
@@ -1212,7 +1487,7 @@ yaml_parser_process_empty_scalar(yaml_parser_t *parser, yaml_event_t *event,
 {
     yaml_char_t *value;
 
-    value = yaml_malloc(1);
+    value = ARENA_MALLOC(parser, 1);
     if (!value) {
         parser->error = YAML_MEMORY_ERROR;
         return 0;
@@ -1270,7 +1545,8 @@ yaml_parser_process_directives(yaml_parser_t *parser,
                         "found incompatible YAML document", token->start_mark);
                 goto error;
             }
-            version_directive = yaml_malloc(sizeof(yaml_version_directive_t));
+            version_directive = CONTEXT_MALLOC(parser,
+                    sizeof(yaml_version_directive_t));
             if (!version_directive) {
                 parser->error = YAML_MEMORY_ERROR;
                 goto error;
@@ -1323,11 +1599,11 @@ yaml_parser_process_directives(yaml_parser_t *parser,
     return 1;
 
 error:
-    yaml_free(version_directive);
+    CONTEXT_FREE(parser, version_directive);
     while (!STACK_EMPTY(parser, tag_directives)) {
         yaml_tag_directive_t tag_directive = POP(parser, tag_directives);
-        yaml_free(tag_directive.handle);
-        yaml_free(tag_directive.prefix);
+        ARENA_FREE(parser, tag_directive.handle);
+        ARENA_FREE(parser, tag_directive.prefix);
     }
     STACK_DEL(parser, tag_directives);
     return 0;
@@ -1341,21 +1617,18 @@ static int
 yaml_parser_append_tag_directive(yaml_parser_t *parser,
         yaml_tag_directive_t value, int allow_duplicates, yaml_mark_t mark)
 {
-    yaml_tag_directive_t *tag_directive;
     yaml_tag_directive_t copy = { NULL, NULL };
+    yaml_tag_data_t tag_data = { NULL, NULL, NULL };
 
-    for (tag_directive = parser->tag_directives.start;
-            tag_directive != parser->tag_directives.top; tag_directive ++) {
-        if (strcmp((char *)value.handle, (char *)tag_directive->handle) == 0) {
-            if (allow_duplicates)
-                return 1;
-            return yaml_parser_set_parser_error(parser,
-                    "found duplicate %TAG directive", mark);
-        }
+    if (yaml_parser_find_tag(parser, value.handle, NULL)->tag) {
+        if (allow_duplicates)
+            return 1;
+        return yaml_parser_set_parser_error(parser,
+                "found duplicate %TAG directive", mark);
     }
 
-    copy.handle = yaml_strdup(value.handle);
-    copy.prefix = yaml_strdup(value.prefix);
+    copy.handle = CONTEXT_STRDUP(parser, value.handle);
+    copy.prefix = CONTEXT_STRDUP(parser, value.prefix);
     if (!copy.handle || !copy.prefix) {
         parser->error = YAML_MEMORY_ERROR;
         goto error;
@@ -1364,11 +1637,161 @@ yaml_parser_append_tag_directive(yaml_parser_t *parser,
     if (!PUSH(parser, parser->tag_directives, copy))
         goto error;
 
-    return 1;
+    /* The table borrows the strings of the directive. */
+
+    tag_data.handle = copy.handle;
+    tag_data.tag = copy.prefix;
+
+    return yaml_parser_add_tag(parser, tag_data);
 
 error:
-    yaml_free(copy.handle);
-    yaml_free(copy.prefix);
+    CONTEXT_FREE(parser, copy.handle);
+    CONTEXT_FREE(parser, copy.prefix);
     return 0;
 }
 
+
+/*
+ * Find a tag directive (with a NULL suffix) or a resolved tag in the table
+ * of tags, or the empty slot where it belongs.
+ *
+ * The table is probed linearly from the FNV-1a hash of the handle and the
+ * suffix.  It is kept at most half full, so there is always an empty slot.
+ */
+
+static yaml_tag_data_t *
+yaml_parser_find_tag(yaml_parser_t *parser,
+        const yaml_char_t *handle, const yaml_char_t *suffix)
+{
+    size_t mask = (parser->tags.end - parser->tags.start) - 1;
+    size_t hash = 2166136261u;
+    const yaml_char_t *pointer;
+    yaml_tag_data_t *tag_data;
+
+    for (pointer = handle; *pointer; pointer ++) {
+        hash = (hash ^ *pointer) * 16777619u;
+    }
+    if (suffix) {
+        hash = (hash ^ '!') * 16777619u;
+        for (pointer = suffix; *pointer; pointer ++) {
+            hash = (hash ^ *pointer) * 16777619u;
+        }
+    }
+
+    tag_data = parser->tags.start + (hash & mask);
+
+    while (tag_data->handle
+            && (strcmp((char *)tag_data->handle, (char *)handle) != 0
+                || !tag_data->suffix != !suffix
+                || (suffix && strcmp((char *)tag_data->suffix,
+                        (char *)suffix) != 0))) {
+        tag_data = parser->tags.start
+            + ((tag_data - parser->tags.start + 1) & mask);
+    }
+
+    return tag_data;
+}
+
+/*
+ * Add a tag directive or a resolved tag to the table of tags, doubling the
+ * table when it would become more than half full.
+ */
+
+static int
+yaml_parser_add_tag(yaml_parser_t *parser, yaml_tag_data_t value)
+{
+    yaml_tag_data_t *start = parser->tags.start;
+    yaml_tag_data_t *end = parser->tags.end;
+    size_t size = end - start;
+    yaml_tag_data_t *tag_data;
+
+    if ((parser->tags.count+1)*2 > size)
+    {
+        size *= 2;
+        if (!(parser->tags.start = CONTEXT_MALLOC(parser,
+                        size*sizeof(yaml_tag_data_t)))) {
+            parser->tags.start = start;
+            parser->error = YAML_MEMORY_ERROR;
+            return 0;
+        }
+        memset(parser->tags.start, 0, size*sizeof(yaml_tag_data_t));
+        parser->tags.end = parser->tags.start + size;
+
+        for (tag_data = start; tag_data != end; tag_data ++) {
+            if (tag_data->handle) {
+                *yaml_parser_find_tag(parser,
+                        tag_data->handle, tag_data->suffix) = *tag_data;
+            }
+        }
+        if (!IS_INLINE(parser, start)) {
+            CONTEXT_FREE(parser, start);
+        }
+    }
+
+    *yaml_parser_find_tag(parser, value.handle, value.suffix) = value;
+    parser->tags.count ++;
+
+    return 1;
+}
+
+/*
+ * Forget the tag directives of a document and the tags resolved with them.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_delete_tag_directives(yaml_parser_t *parser)
+{
+    yaml_tag_data_t *tag_data;
+
+    for (tag_data = parser->tags.start;
+            tag_data != parser->tags.end; tag_data ++) {
+        if (tag_data->suffix) {
+            ARENA_FREE(parser, tag_data->handle);
+            ARENA_FREE(parser, tag_data->suffix);
+            ARENA_FREE(parser, tag_data->tag);
+        }
+    }
+    if (!IS_INLINE(parser, parser->tags.start)) {
+        CONTEXT_FREE(parser, parser->tags.start);
+    }
+    parser->tags.start = parser->storage.tags;
+    parser->tags.end = parser->storage.tags
+        + sizeof(parser->storage.tags)/sizeof(*parser->storage.tags);
+    parser->tags.count = 0;
+    memset(parser->tags.start, 0, sizeof(parser->storage.tags));
+
+    while (!STACK_EMPTY(parser, parser->tag_directives)) {
+        yaml_tag_directive_t tag_directive = POP(parser, parser->tag_directives);
+        CONTEXT_FREE(parser, tag_directive.handle);
+        CONTEXT_FREE(parser, tag_directive.prefix);
+    }
+}
+
+/*
+ * Release the arena after a document, unless a token of the next document
+ * already holds a string in it.
+ */
+
+static void
+yaml_parser_release_arena(yaml_parser_t *parser)
+{
+    size_t index;
+
+    for (index = 0; index < QUEUE_LENGTH(parser, parser->tokens); index ++)
+    {
+        switch (QUEUE_AT(parser, parser->tokens, index).type)
+        {
+            case YAML_TAG_DIRECTIVE_TOKEN:
+            case YAML_ALIAS_TOKEN:
+            case YAML_ANCHOR_TOKEN:
+            case YAML_TAG_TOKEN:
+            case YAML_SCALAR_TOKEN:
+                return;
+
+            default:
+                break;
+        }
+    }
+
+    yaml_arena_release(parser);
+}
@@ -1,5 +1,7 @@
 #include <perl_libyaml.h>
 
+START_MY_CXT
+
 static SV *
 call_coderef(SV *code, AV *args)
 {
@@ -119,8 +121,7 @@ void
 Load(SV *yaml_sv)
 {
     dXSARGS;
-    perl_yaml_loader_t loader;
-    SV *node;
+    perl_yaml_loader_t *loader;
     char *yaml_str;
     STRLEN yaml_len;
     
@@ -132,56 +133,473 @@ Load(SV *yaml_sv)
 
     sp = mark;
     if (0 && (items || ax)) {} /* XXX Quiet the -Wall warnings for now. */
+    PUTBACK;
 
-    yaml_parser_initialize(&loader.parser);
-    loader.document = 0;
-    yaml_parser_set_input_string(
-        &loader.parser,
+    ENTER;
+    loader = acquire_loader();
+    SAVEDESTRUCTOR_X(release_loader, loader);
+    set_loader_options(loader);
+    yaml_parser_set_borrow_scalars(&loader->parser, 1);
+    yaml_parser_set_share_tags(&loader->parser, 1);
+    yaml_parser_set_arena(&loader->parser, 1);
+    yaml_parser_set_input_string_in_place(
+        &loader->parser,
         (unsigned char *)yaml_str,
         yaml_len
     );
 
+    load_stream(loader);
+    LEAVE;
+}
+
+/*
+ * libyaml allocates its memory with the allocator of Perl, so that it is
+ * accounted with the rest of the memory of the interpreter.  Unlike
+ * safemalloc(), PerlMem_malloc() returns NULL when the memory runs out
+ * instead of ending the process, so libyaml reports a memory error and the
+ * call croaks.
+ */
+static yaml_allocator_t perl_yaml_allocator = {
+    perl_yaml_malloc, perl_yaml_realloc, perl_yaml_free, NULL
+};
+
+void
+init_allocator(void)
+{
+    yaml_set_allocator(&perl_yaml_allocator);
+}
+
+static void *
+perl_yaml_malloc(void *data, size_t size)
+{
+    PERL_UNUSED_ARG(data);
+    return PerlMem_malloc(size);
+}
+
+static void *
+perl_yaml_realloc(void *data, void *ptr, size_t size)
+{
+    PERL_UNUSED_ARG(data);
+    return PerlMem_realloc(ptr, size);
+}
+
+static void
+perl_yaml_free(void *data, void *ptr)
+{
+    PERL_UNUSED_ARG(data);
+    PerlMem_free(ptr);
+}
+
+/*
+ * Each interpreter keeps a few reset loaders and a dumper around, so that a
+ * Load or a Dump does not set up a new parser or emitter every time.  Loads
+ * may nest (through code called while loading), so the pool works as a stack.
+ */
+void
+init_pools(void)
+{
+    MY_CXT_INIT;
+    MY_CXT.loader_count = 0;
+    MY_CXT.dumper = NULL;
+    call_atexit(free_pools, NULL);
+}
+
+void
+clone_pools(void)
+{
+    MY_CXT_CLONE;
+    MY_CXT.loader_count = 0;
+    MY_CXT.dumper = NULL;
+    call_atexit(free_pools, NULL);
+}
+
+static void
+free_pools(pTHX_ void *data)
+{
+    dMY_CXT;
+
+    while (MY_CXT.loader_count) {
+        perl_yaml_loader_t *loader = MY_CXT.loaders[--MY_CXT.loader_count];
+        yaml_parser_delete(&loader->parser);
+        Safefree(loader);
+    }
+    if (MY_CXT.dumper) {
+        free_dumper(MY_CXT.dumper);
+        MY_CXT.dumper = NULL;
+    }
+}
+
+static perl_yaml_loader_t *
+acquire_loader(void)
+{
+    dMY_CXT;
+    perl_yaml_loader_t *loader;
+
+    if (MY_CXT.loader_count)
+        return MY_CXT.loaders[--MY_CXT.loader_count];
+
+    Newxz(loader, 1, perl_yaml_loader_t);
+    yaml_parser_initialize(&loader->parser);
+    return loader;
+}
+
+/*
+ * Return a loader to the pool when Load returns or croaks.
+ */
+static void
+release_loader(pTHX_ void *data)
+{
+    dMY_CXT;
+    perl_yaml_loader_t *loader = data;
+
+    if (MY_CXT.loader_count < LOADER_POOL_SIZE) {
+        yaml_parser_reset(&loader->parser);
+        MY_CXT.loaders[MY_CXT.loader_count++] = loader;
+    }
+    else {
+        yaml_parser_delete(&loader->parser);
+        Safefree(loader);
+    }
+}
+
+/*
+ * Release a file loader when LoadFile returns or croaks.
+ */
+static void
+free_file_loader(pTHX_ void *data)
+{
+    perl_yaml_file_loader_t *file_loader = data;
+
+    yaml_parser_delete(&file_loader->loader.parser);
+    fclose(file_loader->file);
+    Safefree(file_loader);
+}
+
+/*
+ * LoadFile maps the file into memory and parses it in place.  Files that
+ * can't be mapped, like empty files, pipes and /proc entries, are read
+ * through stdio instead.
+ */
+void
+LoadFile(SV *filename_sv)
+{
+    dXSARGS;
+    perl_yaml_file_loader_t *file_loader;
+    char *filename = SvPV_nolen(filename_sv);
+    FILE *file;
+
+    sp = mark;
+    if (0 && (items || ax)) {} /* XXX Quiet the -Wall warnings for now. */
+    PUTBACK;
+
+    if (!(file = fopen(filename, "rb")))
+        croak("Can't open '%s' for input:\n%s", filename, Strerror(errno));
+
+    ENTER;
+    Newxz(file_loader, 1, perl_yaml_file_loader_t);
+    file_loader->file = file;
+    yaml_parser_initialize(&file_loader->loader.parser);
+    SAVEDESTRUCTOR_X(free_file_loader, file_loader);
+    set_loader_options(&file_loader->loader);
+    yaml_parser_set_borrow_scalars(&file_loader->loader.parser, 1);
+    yaml_parser_set_share_tags(&file_loader->loader.parser, 1);
+    yaml_parser_set_arena(&file_loader->loader.parser, 1);
+    yaml_parser_set_input_mmap(&file_loader->loader.parser, file);
+
+    load_stream(&file_loader->loader);
+    LEAVE;
+}
+
+/*
+ * Load every document of the stream onto the Perl stack.
+ */
+void
+load_stream(perl_yaml_loader_t *loader)
+{
+    dSP;
+    SV *node;
+
+    loader->document = 0;
+    loader->batch_head = loader->batch_count = 0;
+    loader->batch_error.error = YAML_NO_ERROR;
+
     /* Get the first event. Must be a STREAM_START */
-    if (!yaml_parser_parse(&loader.parser, &loader.event))
+    if (!next_event(loader))
         goto load_error;
-    if (loader.event.type != YAML_STREAM_START_EVENT)
+    if (loader->event.type != YAML_STREAM_START_EVENT)
         croak(ERRMSG "Expected STREAM_START_EVENT; Got: %d != %d",
-            loader.event.type,
+            loader->event.type,
             YAML_STREAM_START_EVENT
          );
 
-    loader.anchors = newHV();
-    sv_2mortal(loader.anchors);
+    loader->anchors = newHV();
+    sv_2mortal((SV *)loader->anchors);
 
     /* Keep calling load_node until end of stream */
     while (1) {
-        loader.document++;
-        if (!yaml_parser_parse(&loader.parser, &loader.event))
+        loader->document++;
+        if (!next_event(loader))
             goto load_error;
-        if (loader.event.type == YAML_STREAM_END_EVENT)
+        if (loader->event.type == YAML_STREAM_END_EVENT)
             break;
-        node = load_node(&loader);
-        hv_clear(loader.anchors);
+        PUTBACK;
+        node = load_node(loader);
+        SPAGAIN;
+        hv_clear(loader->anchors);
         if (! node) break;
         XPUSHs(sv_2mortal(node));
-        if (!yaml_parser_parse(&loader.parser, &loader.event))
+        if (!next_event(loader))
             goto load_error;
-        if (loader.event.type != YAML_DOCUMENT_END_EVENT)
+        if (loader->event.type != YAML_DOCUMENT_END_EVENT)
             croak(ERRMSG "Expected DOCUMENT_END_EVENT");
     }
 
     /* Make sure the last event is a STREAM_END */
-    if (loader.event.type != YAML_STREAM_END_EVENT)
+    if (loader->event.type != YAML_STREAM_END_EVENT)
         croak(ERRMSG "Expected STREAM_END_EVENT; Got: %d != %d",
-            loader.event.type,
+            loader->event.type,
             YAML_STREAM_END_EVENT
          );
-    yaml_parser_delete(&loader.parser);
     PUTBACK;
     return;
 
 load_error:
-    croak(loader_error_msg(&loader, NULL));
+    croak(loader_error_msg(loader, NULL));
+}
+
+/*
+ * Stream objects feed the input in chunks and load each document as soon as
+ * all its events are queued, so only one document is held at a time.
+ */
+perl_yaml_stream_loader_t *
+new_stream_loader(void)
+{
+    perl_yaml_stream_loader_t *stream;
+
+    Newxz(stream, 1, perl_yaml_stream_loader_t);
+    yaml_parser_initialize(&stream->loader.parser);
+    set_loader_options(&stream->loader);
+    yaml_parser_feed(&stream->loader.parser, NULL, 0, 0);
+    stream->loader.anchors = newHV();
+    stream->loader.queue = &stream->queue;
+    Newx(stream->queue.start, 16, yaml_event_t);
+    stream->queue.head = stream->queue.tail = stream->queue.start;
+    stream->queue.end = stream->queue.start + 16;
+
+    return stream;
+}
+
+perl_yaml_stream_loader_t *
+get_stream_loader(SV *self)
+{
+    if (!(sv_isobject(self) &&
+        sv_derived_from(self, "YAML::XS::LibYAML::Stream")))
+        croak(ERRMSG "Not a YAML::XS::LibYAML::Stream object");
+
+    return INT2PTR(perl_yaml_stream_loader_t *, SvIV(SvRV(self)));
+}
+
+static void
+clear_event_queue(perl_yaml_event_queue_t *queue)
+{
+    yaml_event_t *event;
+
+    for (event = queue->start; event != queue->tail; event++)
+        yaml_event_delete(event);
+    queue->head = queue->tail = queue->start;
+}
+
+void
+free_stream_loader(perl_yaml_stream_loader_t *stream)
+{
+    clear_event_queue(&stream->queue);
+    Safefree(stream->queue.start);
+    SvREFCNT_dec((SV *)stream->loader.anchors);
+    yaml_parser_delete(&stream->loader.parser);
+    Safefree(stream);
+}
+
+/*
+ * Append a chunk of the input to the stream.
+ */
+void
+feed_stream(perl_yaml_stream_loader_t *stream, SV *chunk_sv, int is_final)
+{
+    char *chunk = NULL;
+    STRLEN length = 0;
+
+    if (stream->finished) {
+        if (is_final)
+            return;
+        croak(ERRMSG "Can't feed a finished stream");
+    }
+
+    if (chunk_sv) {
+        /* If UTF8, make copy and downgrade */
+        if (SvPV_nolen(chunk_sv) && SvUTF8(chunk_sv)) {
+            chunk_sv = sv_mortalcopy(chunk_sv);
+        }
+        chunk = SvPVbyte(chunk_sv, length);
+    }
+
+    stream->finished = is_final;
+    if (!yaml_parser_feed(
+        &stream->loader.parser,
+        (unsigned char *)chunk,
+        length,
+        is_final
+    ))
+        croak(loader_error_msg(&stream->loader, NULL));
+}
+
+/*
+ * Queue the events of the next document and load it.  Return NULL if the
+ * document is not complete yet or the stream is over.
+ */
+SV *
+load_stream_document(perl_yaml_stream_loader_t *stream)
+{
+    perl_yaml_loader_t *loader = &stream->loader;
+    perl_yaml_event_queue_t *queue = &stream->queue;
+    SV *node;
+
+    /* Drop the events of a document that failed to load */
+    if (queue->head != queue->start) {
+        clear_event_queue(queue);
+        hv_clear(loader->anchors);
+    }
+
+    while (!stream->stream_ended) {
+        yaml_event_t event;
+
+        if (!yaml_parser_parse(&loader->parser, &event))
+            croak(loader_error_msg(loader, NULL));
+        if (event.type == YAML_NO_EVENT)
+            return NULL;
+
+        if (!stream->stream_started) {
+            if (event.type != YAML_STREAM_START_EVENT)
+                croak(ERRMSG "Expected STREAM_START_EVENT; Got: %d != %d",
+                    event.type,
+                    YAML_STREAM_START_EVENT
+                 );
+            stream->stream_started = 1;
+            continue;
+        }
+        if (event.type == YAML_STREAM_END_EVENT) {
+            stream->stream_ended = 1;
+            break;
+        }
+
+        if (queue->tail == queue->end) {
+            size_t size = queue->end - queue->start;
+            Renew(queue->start, size * 2, yaml_event_t);
+            queue->head = queue->start;
+            queue->tail = queue->start + size;
+            queue->end = queue->start + size * 2;
+        }
+        *queue->tail++ = event;
+
+        if (event.type != YAML_DOCUMENT_END_EVENT)
+            continue;
+
+        /* The document is complete; skip DOCUMENT_START and load it */
+        loader->document++;
+        loader->event = *queue->head++;
+        node = load_node(loader);
+        hv_clear(loader->anchors);
+        if (!node || load_node(loader))
+            croak(ERRMSG "Expected DOCUMENT_END_EVENT");
+        clear_event_queue(queue);
+        return node;
+    }
+
+    return NULL;
+}
+
+/*
+ * Take a parse error out of the parser and hold it in the loader.
+ */
+static void
+hold_parse_error(perl_yaml_loader_t *loader)
+{
+    perl_yaml_parse_error_t *held = &loader->batch_error;
+    yaml_parser_t *parser = &loader->parser;
+
+    held->error = parser->error;
+    held->problem = parser->problem;
+    held->problem_offset = parser->problem_offset;
+    held->problem_value = parser->problem_value;
+    held->problem_mark = parser->problem_mark;
+    held->context = parser->context;
+    held->context_mark = parser->context_mark;
+
+    parser->error = YAML_NO_ERROR;
+    parser->problem = NULL;
+    parser->context = NULL;
+    memset(&parser->problem_mark, 0, sizeof(yaml_mark_t));
+    memset(&parser->context_mark, 0, sizeof(yaml_mark_t));
+}
+
+/*
+ * Put a held parse error back into the parser.
+ */
+static void
+release_parse_error(perl_yaml_loader_t *loader)
+{
+    perl_yaml_parse_error_t *held = &loader->batch_error;
+    yaml_parser_t *parser = &loader->parser;
+
+    parser->error = held->error;
+    parser->problem = held->problem;
+    parser->problem_offset = held->problem_offset;
+    parser->problem_value = held->problem_value;
+    parser->problem_mark = held->problem_mark;
+    parser->context = held->context;
+    parser->context_mark = held->context_mark;
+
+    held->error = YAML_NO_ERROR;
+}
+
+/*
+ * Get the next event of the document, from the queue of a stream object if
+ * there is one.  Otherwise the events are parsed a batch at a time; a parse
+ * error is held back until the events parsed before it are used up, so that
+ * an error found while loading them reports its own position.
+ */
+static int
+next_event(perl_yaml_loader_t *loader)
+{
+    if (loader->queue) {
+        if (loader->queue->head == loader->queue->tail)
+            croak(ERRMSG "Unexpected end of queued events");
+        loader->event = *loader->queue->head++;
+        return 1;
+    }
+
+    if (loader->batch_head == loader->batch_count) {
+        if (loader->batch_error.error) {
+            release_parse_error(loader);
+            memset(&loader->event, 0, sizeof(yaml_event_t));
+            return 0;
+        }
+        loader->batch_head = 0;
+        yaml_parser_parse_batch(
+            &loader->parser,
+            loader->batch,
+            LOADER_BATCH_SIZE,
+            &loader->batch_count
+        );
+        if (!loader->batch_count) {
+            memset(&loader->event, 0, sizeof(yaml_event_t));
+            return !loader->parser.error;
+        }
+        if (loader->parser.error)
+            hold_parse_error(loader);
+    }
+
+    loader->event = loader->batch[loader->batch_head++];
+    return 1;
 }
 
 /*
@@ -191,7 +609,7 @@ SV *
 load_node(perl_yaml_loader_t *loader)
 {
     /* Get the next parser event */
-    if (!yaml_parser_parse(&loader->parser, &loader->event))
+    if (!next_event(loader))
         goto load_error;
 
     /* Return NULL when we hit the end of a scope */
@@ -264,6 +682,8 @@ load_mapping(perl_yaml_loader_t *loader, char *tag)
         hv_store_ent(
             hash, key_node, value_node, 0
         );
+        /* hv_store_ent copies the key */
+        SvREFCNT_dec(key_node);
     } 
 
     /* Deal with possibly blessing the hash if the YAML tag has a class */
@@ -340,19 +760,20 @@ load_scalar(perl_yaml_loader_t *loader)
             ! strnEQ(tag, prefix, strlen(prefix))
         ) croak(ERRMSG "bad tag found for scalar: '%s'", tag);
         class = tag + strlen(prefix);
-        scalar = sv_setref_pvn(newSV(0), class, string, strlen(string));
+        scalar = sv_setref_pvn(newSV(0), class, string, length);
         SvUTF8_on(scalar);
 	return scalar;
     }
 
+    /* The string may be borrowed from the input and not NUL-terminated. */
     if (loader->event.data.scalar.style == YAML_PLAIN_SCALAR_STYLE) {
-        if (strEQ(string, "~"))
+        if (length == 1 && *string == '~')
             return newSV(0);
-        else if (strEQ(string, ""))
+        else if (length == 0)
             return newSV(0);
-        else if (strEQ(string, "true"))
+        else if (length == 4 && memEQ(string, "true", 4))
             return &PL_sv_yes;
-        else if (strEQ(string, "false"))
+        else if (length == 5 && memEQ(string, "false", 5))
             return &PL_sv_no;
     }
 
@@ -449,6 +870,20 @@ load_glob(perl_yaml_loader_t *loader)
 
 /* -------------------------------------------------------------------------- */
 
+/*
+ * Get the buffer size for the parser and the emitter from
+ * $YAML::XS::BufferSize (0 for the default).
+ */
+static size_t
+get_buffer_size(void)
+{
+    GV *gv;
+    if ((gv = gv_fetchpv("YAML::XS::BufferSize", TRUE, SVt_PV)) &&
+        SvOK(GvSV(gv)) && SvIV(GvSV(gv)) > 0)
+        return (size_t)SvIV(GvSV(gv));
+    return 0;
+}
+
 /*
  * Set dumper options from global variables.
  */
@@ -463,6 +898,18 @@ set_dumper_options(perl_yaml_dumper_t *dumper)
         ((gv = gv_fetchpv("YAML::XS::DumpCode", TRUE, SVt_PV)) &&
         SvTRUE(GvSV(gv)))
     );
+    if (!yaml_emitter_set_buffer_size(&dumper->emitter, get_buffer_size()))
+        croak(DUMPERRMSG "Can't allocate the output buffer");
+}
+
+/*
+ * Set loader options from global variables.  Must be called before the input
+ * is set.
+ */
+void
+set_loader_options(perl_yaml_loader_t *loader)
+{
+    yaml_parser_set_buffer_size(&loader->parser, get_buffer_size());
 }
 
 /*
@@ -473,57 +920,182 @@ void
 Dump(SV *dummy, ...)
 {
     dXSARGS;
-    perl_yaml_dumper_t dumper;
-    yaml_event_t event_stream_start;
-    yaml_event_t event_stream_end;
-    int i;
+    perl_yaml_dumper_t *dumper;
     SV *yaml = sv_2mortal(newSVpvn("", 0));
     sp = mark;
 
-    set_dumper_options(&dumper);
+    ENTER;
+    dumper = acquire_dumper();
+    SAVEDESTRUCTOR_X(release_dumper, dumper);
+    set_dumper_options(dumper);
+    dump_stream(dumper, NULL, (void *) yaml, ax, 0, items);
+    LEAVE;
+
+    /* Put the YAML stream scalar on the XS output stack */
+    if (yaml) {
+        *SvEND(yaml) = '\0';
+#ifdef SvPV_shrink_to_cur
+        SvPV_shrink_to_cur(yaml);
+#endif
+        SvUTF8_off(yaml);
+        XPUSHs(yaml);
+    }
+    PUTBACK;
+}
+
+/*
+ * DumpFile takes a filehandle and zero or more Perl objects, and writes the
+ * YAML stream to the handle as the emitter flushes its buffer, followed by
+ * $\ like print does.  A handle with a utf8 layer gets the octets upgraded,
+ * as print would upgrade the string from Dump.  A tied handle gets the whole
+ * stream through its PRINT method instead.
+ */
+void
+DumpFile(SV *dummy, ...)
+{
+    dXSARGS;
+    perl_yaml_dumper_t *dumper;
+    PerlIO *output = NULL;
+    MAGIC *mg = NULL;
+    SV *yaml = NULL;
+    IO *io;
+    int ok;
+
+    sp = mark;
+
+    if (items < 1 || !(io = sv_2io(ST(0))) || (
+            !(mg = SvTIED_mg((SV *)io, PERL_MAGIC_tiedscalar)) &&
+            !(output = IoOFP(io))))
+        croak(DUMPERRMSG "Filehandle is not opened for output");
+
+    ENTER;
+    dumper = acquire_dumper();
+    SAVEDESTRUCTOR_X(release_dumper, dumper);
+    set_dumper_options(dumper);
+    if (mg) {
+        yaml = sv_2mortal(newSVpvn("", 0));
+        dump_stream(dumper, NULL, (void *) yaml, ax, 1, items);
+        ok = 1;
+    }
+    else {
+        yaml_write_handler_t *handler =
+            PerlIO_isutf8(output) ? &write_output_utf8 : &write_output;
+        ok = dump_stream(dumper, handler, (void *) output, ax, 1, items);
+        if (ok && PL_ors_sv && SvOK(PL_ors_sv)) {
+            STRLEN len;
+            char *ors = PerlIO_isutf8(output)
+                ? SvPVutf8(sv_2mortal(newSVsv(PL_ors_sv)), len)
+                : SvPV(PL_ors_sv, len);
+            ok = write_output((void *) output, (unsigned char *) ors, len);
+        }
+    }
+    if (!ok)
+        croak(DUMPERRMSG "Can't write to the filehandle:\n%s",
+            Strerror(errno));
+    LEAVE;
+
+    if (yaml) {
+        *SvEND(yaml) = '\0';
+        SvUTF8_off(yaml);
+        print_tied(io, mg, yaml);
+    }
+    PUTBACK;
+}
+
+/*
+ * Emit the objects ST(first) .. ST(items - 1) as a YAML stream through the
+ * given output handler, or into the string SV data if there is no handler.
+ * Return 0 if the handler failed.
+ */
+int
+dump_stream(perl_yaml_dumper_t *dumper, yaml_write_handler_t *handler,
+    void *data, I32 ax, I32 first, I32 items)
+{
+    yaml_event_t event_stream_start;
+    yaml_event_t event_stream_end;
+    int ok;
+    int i;
 
     /* Set up the emitter object and begin emitting */
-    yaml_emitter_initialize(&dumper.emitter);
-    yaml_emitter_set_unicode(&dumper.emitter, 1);
-    yaml_emitter_set_width(&dumper.emitter, 2);
-    yaml_emitter_set_output(
-        &dumper.emitter,
-        &append_output,
-        (void *) yaml
-    );
+    yaml_emitter_set_unicode(&dumper->emitter, 1);
+    yaml_emitter_set_width(&dumper->emitter, 2);
+    if (handler)
+        yaml_emitter_set_output(&dumper->emitter, handler, data);
+    else
+        yaml_emitter_set_output_buffer(&dumper->emitter, &grow_output, data);
     yaml_stream_start_event_initialize(
         &event_stream_start,
         YAML_UTF8_ENCODING
     );
-    yaml_emitter_emit(&dumper.emitter, &event_stream_start);
+    yaml_emitter_emit(&dumper->emitter, &event_stream_start);
 
-    dumper.anchors = newHV();
-    dumper.shadows = newHV();
+    for (i = first; i < items; i++) {
+        dumper->anchor = 0;
 
-    sv_2mortal((SV *)dumper.anchors);
-    sv_2mortal((SV *)dumper.shadows);
+        dump_prewalk(dumper, ST(i));
+        dump_document(dumper, ST(i));
+
+        hv_clear(dumper->anchors);
+        hv_clear(dumper->shadows);
+    }
+
+    /* End emitting */
+    yaml_stream_end_event_initialize(&event_stream_end);
+    yaml_emitter_emit(&dumper->emitter, &event_stream_end);
+    ok = dumper->emitter.error != YAML_WRITER_ERROR;
 
-    for (i = 0; i < items; i++) {
-        dumper.anchor = 0;
+    return ok;
+}
 
-        dump_prewalk(&dumper, ST(i));
-        dump_document(&dumper, ST(i));
+/*
+ * Take the cached dumper of the interpreter, or make a new one if a Dump is
+ * already using it.
+ */
+static perl_yaml_dumper_t *
+acquire_dumper(void)
+{
+    dMY_CXT;
+    perl_yaml_dumper_t *dumper = MY_CXT.dumper;
 
-        hv_clear(dumper.anchors);
-        hv_clear(dumper.shadows);
+    if (dumper) {
+        MY_CXT.dumper = NULL;
+        return dumper;
     }
 
-    /* End emitting and destroy the emitter object */
-    yaml_stream_end_event_initialize(&event_stream_end);
-    yaml_emitter_emit(&dumper.emitter, &event_stream_end);
-    yaml_emitter_delete(&dumper.emitter);
+    Newxz(dumper, 1, perl_yaml_dumper_t);
+    yaml_emitter_initialize(&dumper->emitter);
+    dumper->anchors = newHV();
+    dumper->shadows = newHV();
+    return dumper;
+}
 
-    /* Put the YAML stream scalar on the XS output stack */
-    if (yaml) {
-        SvUTF8_off(yaml);
-        XPUSHs(yaml);
+/*
+ * Put a dumper back into the cache when Dump returns or croaks.
+ */
+static void
+release_dumper(pTHX_ void *data)
+{
+    dMY_CXT;
+    perl_yaml_dumper_t *dumper = data;
+
+    if (MY_CXT.dumper) {
+        free_dumper(dumper);
+        return;
     }
-    PUTBACK;
+
+    yaml_emitter_reset(&dumper->emitter);
+    hv_clear(dumper->anchors);
+    hv_clear(dumper->shadows);
+    MY_CXT.dumper = dumper;
+}
+
+static void
+free_dumper(perl_yaml_dumper_t *dumper)
+{
+    yaml_emitter_delete(&dumper->emitter);
+    SvREFCNT_dec((SV *)dumper->anchors);
+    SvREFCNT_dec((SV *)dumper->shadows);
+    Safefree(dumper);
 }
 
 /*
@@ -948,13 +1520,62 @@ dump_ref(perl_yaml_dumper_t *dumper, SV *node)
     yaml_emitter_emit(&dumper->emitter, &event_mapping_end);
 }
 
+/*
+ * The emitter writes into the PV buffer of the YAML string, growing it as
+ * needed.  Keep one byte for the trailing NUL.
+ */
 int
-append_output(void *yaml, unsigned char *buffer, unsigned int size)
+grow_output(void *yaml, size_t length, unsigned char **buffer, size_t *size)
 {
-    sv_catpvn((SV *)yaml, (const char *)buffer, (STRLEN)size);
+    SvCUR_set((SV *)yaml, (STRLEN)length);
+    if (*size >= SvLEN((SV *)yaml))
+        SvGROW((SV *)yaml, (STRLEN)*size + 1);
+    *buffer = (unsigned char *)SvPVX((SV *)yaml);
+    *size = SvLEN((SV *)yaml) - 1;
     return 1;
 }
 
+/* Write a chunk of YAML to a PerlIO handle */
+int
+write_output(void *output, unsigned char *buffer, size_t size)
+{
+    return PerlIO_write((PerlIO *)output, buffer, (Size_t)size)
+        == (SSize_t)size;
+}
+
+/*
+ * Write a chunk of YAML to a PerlIO handle with a utf8 layer.  The octets
+ * are upgraded like print upgrades a byte string, so the handle gets the
+ * same output as print $fh Dump(...).
+ */
+int
+write_output_utf8(void *output, unsigned char *buffer, size_t size)
+{
+    STRLEN length = (STRLEN)size;
+    U8 *chars = bytes_to_utf8((U8 *)buffer, &length);
+    int ok = PerlIO_write((PerlIO *)output, chars, (Size_t)length)
+        == (SSize_t)length;
+    Safefree(chars);
+    return ok;
+}
+
+/* Print a YAML stream to a tied filehandle */
+static void
+print_tied(IO *io, MAGIC *mg, SV *yaml)
+{
+    dSP;
+
+    ENTER;
+    SAVETMPS;
+    PUSHMARK(SP);
+    XPUSHs(SvTIED_obj((SV *)io, mg));
+    XPUSHs(yaml);
+    PUTBACK;
+    call_method("PRINT", G_SCALAR | G_DISCARD);
+    FREETMPS;
+    LEAVE;
+}
+
 /* XXX Make -Wall not complain about 'local_patches' not being used. */
 #if !defined(PERL_PATCHLEVEL_H_IMPLICIT)
 void xxx_local_patches() {
@@ -23,14 +23,54 @@
 #define LOADERRMSG "YAML::XS::Load Error: "
 #define DUMPERRMSG "YAML::XS::Dump Error: "
 
+typedef struct {
+    yaml_event_t *start;
+    yaml_event_t *head;
+    yaml_event_t *tail;
+    yaml_event_t *end;
+} perl_yaml_event_queue_t;
+
+#define LOADER_BATCH_SIZE 64
+
+typedef struct {
+    yaml_error_type_t error;
+    const char *problem;
+    size_t problem_offset;
+    int problem_value;
+    yaml_mark_t problem_mark;
+    const char *context;
+    yaml_mark_t context_mark;
+} perl_yaml_parse_error_t;
+
 typedef struct {
     yaml_parser_t parser;
     yaml_event_t event;
     HV *anchors;
     int load_code;
     int document;
+    perl_yaml_event_queue_t *queue;
+    yaml_event_t batch[LOADER_BATCH_SIZE];
+    size_t batch_head;
+    size_t batch_count;
+    perl_yaml_parse_error_t batch_error;
 } perl_yaml_loader_t;
 
+typedef struct {
+    perl_yaml_loader_t loader;
+    FILE *file;
+} perl_yaml_file_loader_t;
+
+typedef struct {
+    perl_yaml_loader_t loader;
+    perl_yaml_event_queue_t queue;
+    int stream_started;
+    int stream_ended;
+    int finished;
+} perl_yaml_stream_loader_t;
+
+#define MY_CXT_KEY "YAML::XS::LibYAML::_guts" XS_VERSION
+#define LOADER_POOL_SIZE 4
+
 typedef struct {
     yaml_emitter_t emitter;
     long anchor;
@@ -39,6 +79,12 @@ typedef struct {
     int dump_code;
 } perl_yaml_dumper_t;
 
+typedef struct {
+    perl_yaml_loader_t *loaders[LOADER_POOL_SIZE];
+    int loader_count;
+    perl_yaml_dumper_t *dumper;
+} my_cxt_t;
+
 static SV *
 call_coderef(SV *, AV *);
 
@@ -52,14 +98,84 @@ void
 set_dumper_options(perl_yaml_dumper_t *);
 
 void
-set_loader_options(perl_yaml_dumper_t *);
+set_loader_options(perl_yaml_loader_t *);
+
+static size_t
+get_buffer_size(void);
 
 void
 Dump(SV *, ...);
 
+void
+DumpFile(SV *, ...);
+
+static perl_yaml_dumper_t *
+acquire_dumper(void);
+
+static void
+release_dumper(pTHX_ void *);
+
+static void
+free_dumper(perl_yaml_dumper_t *);
+
+int
+dump_stream(perl_yaml_dumper_t *, yaml_write_handler_t *, void *, I32, I32,
+    I32);
+
 void
 Load(SV *);
 
+void
+LoadFile(SV *);
+
+void
+init_allocator(void);
+
+static void *
+perl_yaml_malloc(void *, size_t);
+
+static void *
+perl_yaml_realloc(void *, void *, size_t);
+
+static void
+perl_yaml_free(void *, void *);
+
+void
+init_pools(void);
+
+void
+clone_pools(void);
+
+static void
+free_pools(pTHX_ void *);
+
+static perl_yaml_loader_t *
+acquire_loader(void);
+
+static void
+release_loader(pTHX_ void *);
+
+void
+load_stream(perl_yaml_loader_t *);
+
+perl_yaml_stream_loader_t *
+new_stream_loader(void);
+
+perl_yaml_stream_loader_t *
+get_stream_loader(SV *);
+
+void
+free_stream_loader(perl_yaml_stream_loader_t *);
+
+void
+feed_stream(perl_yaml_stream_loader_t *, SV *, int);
+
+SV *
+load_stream_document(perl_yaml_stream_loader_t *);
+
+static int
+next_event(perl_yaml_loader_t *);
+
 SV *
 load_node(perl_yaml_loader_t *);
 
@@ -121,5 +237,14 @@ get_yaml_tag(SV *);
 
 
 int
-append_output(void *, unsigned char *, unsigned int size);
+grow_output(void *, size_t, unsigned char **, size_t *);
+
+int
+write_output(void *, unsigned char *, size_t size);
+
+int
+write_output_utf8(void *, unsigned char *, size_t size);
+
+static void
+print_tied(IO *, MAGIC *, SV *);
 
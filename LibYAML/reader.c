@@ -15,6 +15,20 @@ yaml_parser_update_raw_buffer(yaml_parser_t *parser);
 static int
 yaml_parser_determine_encoding(yaml_parser_t *parser);
 
+static int
+yaml_parser_decode_utf8(yaml_parser_t *parser, const unsigned char *pointer,
+        size_t raw_unread, unsigned int *value);
+
+static size_t
+yaml_parser_scan_ascii(const unsigned char *pointer, size_t length);
+
+static int
+yaml_parser_check_in_place(yaml_parser_t *parser, yaml_char_t **pointer,
+        const yaml_char_t *limit, size_t *count);
+
+static int
+yaml_parser_update_buffer_in_place(yaml_parser_t *parser, size_t length);
+
 YAML_DECLARE(int)
 yaml_parser_update_buffer(yaml_parser_t *parser, size_t length);
 
@@ -105,6 +119,17 @@ yaml_parser_update_raw_buffer(yaml_parser_t *parser)
 
     if (parser->eof) return 1;
 
+    /* A pushed input is already in the raw buffer; wait for the next chunk. */
+
+    if (parser->push) {
+        if (!parser->push_final) {
+            parser->input_needed = 1;
+            return 0;
+        }
+        parser->eof = 1;
+        return 1;
+    }
+
     /* Move the remaining bytes in the raw buffer to the beginning. */
 
     if (parser->raw_buffer.start < parser->raw_buffer.pointer
@@ -131,17 +156,267 @@ yaml_parser_update_raw_buffer(yaml_parser_t *parser)
     return 1;
 }
 
+/*
+ * Decode a UTF-8 character.  Check RFC 3629
+ * (http://www.ietf.org/rfc/rfc3629.txt) for more details.
+ *
+ * The following table (taken from the RFC) is used for
+ * decoding.
+ *
+ *    Char. number range |        UTF-8 octet sequence
+ *      (hexadecimal)    |              (binary)
+ *   --------------------+------------------------------------
+ *   0000 0000-0000 007F | 0xxxxxxx
+ *   0000 0080-0000 07FF | 110xxxxx 10xxxxxx
+ *   0000 0800-0000 FFFF | 1110xxxx 10xxxxxx 10xxxxxx
+ *   0001 0000-0010 FFFF | 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+ *
+ * Additionally, the characters in the range 0xD800-0xDFFF
+ * are prohibited as they are reserved for use with UTF-16
+ * surrogate pairs.
+ *
+ * Return the width of the sequence, or 0 on failure.  If the width exceeds
+ * `raw_unread`, the character is incomplete and is not decoded.
+ */
+
+static int
+yaml_parser_decode_utf8(yaml_parser_t *parser, const unsigned char *pointer,
+        size_t raw_unread, unsigned int *value)
+{
+    unsigned char octet;
+    unsigned int width;
+    size_t k;
+
+    /* Determine the length of the UTF-8 sequence. */
+
+    octet = pointer[0];
+    width = (octet & 0x80) == 0x00 ? 1 :
+            (octet & 0xE0) == 0xC0 ? 2 :
+            (octet & 0xF0) == 0xE0 ? 3 :
+            (octet & 0xF8) == 0xF0 ? 4 : 0;
+
+    /* Check if the leading octet is valid. */
+
+    if (!width)
+        return yaml_parser_set_reader_error(parser,
+                "Invalid leading UTF-8 octet",
+                parser->offset, octet);
+
+    /* Check if the raw buffer contains an incomplete character. */
+
+    if (width > raw_unread)
+        return width;
+
+    /* Decode the leading octet. */
+
+    *value = (octet & 0x80) == 0x00 ? octet & 0x7F :
+             (octet & 0xE0) == 0xC0 ? octet & 0x1F :
+             (octet & 0xF0) == 0xE0 ? octet & 0x0F :
+             (octet & 0xF8) == 0xF0 ? octet & 0x07 : 0;
+
+    /* Check and decode the trailing octets. */
+
+    for (k = 1; k < width; k ++)
+    {
+        octet = pointer[k];
+
+        /* Check if the octet is valid. */
+
+        if ((octet & 0xC0) != 0x80)
+            return yaml_parser_set_reader_error(parser,
+                    "Invalid trailing UTF-8 octet",
+                    parser->offset+k, octet);
+
+        /* Decode the octet. */
+
+        *value = (*value << 6) + (octet & 0x3F);
+    }
+
+    /* Check the length of the sequence against the value. */
+
+    if (!((width == 1) ||
+            (width == 2 && *value >= 0x80) ||
+            (width == 3 && *value >= 0x800) ||
+            (width == 4 && *value >= 0x10000)))
+        return yaml_parser_set_reader_error(parser,
+                "Invalid length of a UTF-8 sequence",
+                parser->offset, -1);
+
+    /* Check the range of the value. */
+
+    if ((*value >= 0xD800 && *value <= 0xDFFF) || *value > 0x10FFFF)
+        return yaml_parser_set_reader_error(parser,
+                "Invalid Unicode character",
+                parser->offset, *value);
+
+    return width;
+}
+
+/*
+ * Check if the character is in the allowed range:
+ *      #x9 | #xA | #xD | [#x20-#x7E]               (8 bit)
+ *      | #x85 | [#xA0-#xD7FF] | [#xE000-#xFFFD]    (16 bit)
+ *      | [#x10000-#x10FFFF]                        (32 bit)
+ */
+
+#define IS_ALLOWED(value)                                                       \
+    ((value) == 0x09 || (value) == 0x0A || (value) == 0x0D                      \
+     || ((value) >= 0x20 && (value) <= 0x7E)                                    \
+     || ((value) == 0x85) || ((value) >= 0xA0 && (value) <= 0xD7FF)             \
+     || ((value) >= 0xE000 && (value) <= 0xFFFD)                                \
+     || ((value) >= 0x10000 && (value) <= 0x10FFFF))
+
+/*
+ * Scan a run of plain ASCII characters.
+ *
+ * Most of the input is plain ASCII.  Such octets need not be decoded: it is
+ * enough to check that they are allowed characters and to copy them into the
+ * buffer as is.  The functions below return the length of the longest prefix
+ * of the octets that consists of the characters #x9 | #xA | #xD | [#x20-#x7E].
+ * The SSE2 and AVX2 variants check 16 and 32 octets at once; the rest of the
+ * run is checked by the scalar loop.
+ */
+
+#define IS_PLAIN_ASCII(octet)                                                   \
+    (((octet) >= 0x20 && (octet) <= 0x7E)                                       \
+     || (octet) == 0x09 || (octet) == 0x0A || (octet) == 0x0D)
+
+static size_t
+yaml_parser_scan_ascii_scalar(const unsigned char *pointer, size_t length)
+{
+    size_t k = 0;
+
+    while (k < length && IS_PLAIN_ASCII(pointer[k]))
+        k ++;
+
+    return k;
+}
+
+#if defined(__SSE2__)
+
+#include <emmintrin.h>
+
+static size_t
+yaml_parser_scan_ascii_sse2(const unsigned char *pointer, size_t length)
+{
+    const __m128i space = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i tab = _mm_set1_epi8(0x09);
+    const __m128i lf = _mm_set1_epi8(0x0A);
+    const __m128i cr = _mm_set1_epi8(0x0D);
+    size_t k = 0;
+
+    while (k + 16 <= length)
+    {
+        __m128i octets = _mm_loadu_si128((const __m128i *)(pointer + k));
+
+        /* Octets above 0x7F are negative and fail the signed comparison. */
+
+        __m128i valid = _mm_andnot_si128(_mm_cmpeq_epi8(octets, del),
+                _mm_cmpgt_epi8(octets, space));
+
+        valid = _mm_or_si128(valid, _mm_cmpeq_epi8(octets, tab));
+        valid = _mm_or_si128(valid, _mm_cmpeq_epi8(octets, lf));
+        valid = _mm_or_si128(valid, _mm_cmpeq_epi8(octets, cr));
+
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+            break;
+
+        k += 16;
+    }
+
+    return k + yaml_parser_scan_ascii_scalar(pointer + k, length - k);
+}
+
+#endif
+
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ >= 5)
+
+#define YAML_HAVE_AVX2_DISPATCH 1
+
+#include <immintrin.h>
+
+__attribute__((target("avx2")))
+static size_t
+yaml_parser_scan_ascii_avx2(const unsigned char *pointer, size_t length)
+{
+    const __m256i space = _mm256_set1_epi8(0x1F);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    const __m256i tab = _mm256_set1_epi8(0x09);
+    const __m256i lf = _mm256_set1_epi8(0x0A);
+    const __m256i cr = _mm256_set1_epi8(0x0D);
+    size_t k = 0;
+
+    while (k + 32 <= length)
+    {
+        __m256i octets = _mm256_loadu_si256((const __m256i *)(pointer + k));
+        __m256i valid = _mm256_andnot_si256(_mm256_cmpeq_epi8(octets, del),
+                _mm256_cmpgt_epi8(octets, space));
+
+        valid = _mm256_or_si256(valid, _mm256_cmpeq_epi8(octets, tab));
+        valid = _mm256_or_si256(valid, _mm256_cmpeq_epi8(octets, lf));
+        valid = _mm256_or_si256(valid, _mm256_cmpeq_epi8(octets, cr));
+
+        if (_mm256_movemask_epi8(valid) != -1)
+            break;
+
+        k += 32;
+    }
+
+    return k + yaml_parser_scan_ascii_sse2(pointer + k, length - k);
+}
+
+#endif
+
+/*
+ * Select the best implementation on the first call.
+ */
+
+typedef size_t yaml_parser_scan_ascii_t(const unsigned char *pointer,
+        size_t length);
+
+static yaml_parser_scan_ascii_t *yaml_parser_scan_ascii_impl = NULL;
+
+static size_t
+yaml_parser_scan_ascii(const unsigned char *pointer, size_t length)
+{
+    if (!yaml_parser_scan_ascii_impl)
+    {
+#if defined(YAML_HAVE_AVX2_DISPATCH)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            yaml_parser_scan_ascii_impl = yaml_parser_scan_ascii_avx2;
+        else
+            yaml_parser_scan_ascii_impl = yaml_parser_scan_ascii_sse2;
+#elif defined(__SSE2__)
+        yaml_parser_scan_ascii_impl = yaml_parser_scan_ascii_sse2;
+#else
+        yaml_parser_scan_ascii_impl = yaml_parser_scan_ascii_scalar;
+#endif
+    }
+
+    return yaml_parser_scan_ascii_impl(pointer, length);
+}
+
 /*
  * Ensure that the buffer contains at least `length` characters.
  * Return 1 on success, 0 on failure.
  *
  * The length is supposed to be significantly less that the buffer size.
+ *
+ * The character after the buffered ones always ends a run of characters
+ * within a line: the buffer is followed by INPUT_BUFFER_PADDING NUL octets,
+ * and the checked part of an input read in place stops at a line break.  A
+ * scanner loop over blanks or comment characters does not need to check the
+ * cache for each of them, but only where the run stops.
  */
 
 YAML_DECLARE(int)
 yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
 {
-    assert(parser->read_handler);   /* Read handler must be set. */
+    int first = 1;
+
+    assert(parser->read_handler || parser->push);   /* Input must be set. */
 
     /* If the EOF flag is set and the raw buffer is empty, do nothing. */
 
@@ -153,6 +428,27 @@ yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
     if (parser->unread >= length)
         return 1;
 
+    /* Check a string input in place if it allows it. */
+
+    if (parser->in_place)
+        return yaml_parser_update_buffer_in_place(parser, length);
+
+    /*
+     * Allocate the buffers on the first call.  A short string input does not
+     * need the full size buffers.
+     */
+
+    if (!parser->raw_buffer.start) {
+        size_t raw_size = INPUT_RAW_BUFFER_SIZE_FOR(parser);
+
+        if (!BUFFER_INIT(parser, parser->raw_buffer, raw_size))
+            return 0;
+        if (!BUFFER_INIT(parser, parser->buffer,
+                    raw_size*(INPUT_BUFFER_SIZE/INPUT_RAW_BUFFER_SIZE)
+                    + INPUT_BUFFER_PADDING))
+            return 0;
+    }
+
     /* Determine the input encoding if it is not known yet. */
 
     if (!parser->encoding) {
@@ -160,16 +456,21 @@ yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
             return 0;
     }
 
-    /* Move the unread characters to the beginning of the buffer. */
+    /*
+     * Move the unread characters to the beginning of the buffer.  The buffer
+     * of a pushed input is only moved by yaml_parser_feed() as the scanner
+     * may need to return to an earlier position.
+     */
 
-    if (parser->buffer.start < parser->buffer.pointer
+    if (!parser->push
+            && parser->buffer.start < parser->buffer.pointer
             && parser->buffer.pointer < parser->buffer.last) {
         size_t size = parser->buffer.last - parser->buffer.pointer;
         memmove(parser->buffer.start, parser->buffer.pointer, size);
         parser->buffer.pointer = parser->buffer.start;
         parser->buffer.last = parser->buffer.start + size;
     }
-    else if (parser->buffer.pointer == parser->buffer.last) {
+    else if (!parser->push && parser->buffer.pointer == parser->buffer.last) {
         parser->buffer.pointer = parser->buffer.start;
         parser->buffer.last = parser->buffer.start;
     }
@@ -178,9 +479,11 @@ yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
 
     while (parser->unread < length)
     {
-        /* Fill the raw buffer. */
+        /* Fill the raw buffer.  A pushed input is decoded first. */
 
-        if (!yaml_parser_update_raw_buffer(parser)) return 0;
+        if (!(parser->push && first)
+                && !yaml_parser_update_raw_buffer(parser)) return 0;
+        first = 0;
 
         /* Decode the raw buffer. */
 
@@ -188,52 +491,36 @@ yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
         {
             unsigned int value = 0, value2 = 0;
             int incomplete = 0;
-            unsigned char octet;
             unsigned int width = 0;
             int low, high;
-            size_t k;
             size_t raw_unread = parser->raw_buffer.last - parser->raw_buffer.pointer;
 
+            /* Copy a run of plain ASCII characters without decoding. */
+
+            if (parser->encoding == YAML_UTF8_ENCODING) {
+                size_t run = yaml_parser_scan_ascii(parser->raw_buffer.pointer,
+                        raw_unread);
+                if (run) {
+                    memcpy(parser->buffer.last, parser->raw_buffer.pointer, run);
+                    parser->buffer.last += run;
+                    parser->raw_buffer.pointer += run;
+                    parser->offset += run;
+                    parser->unread += run;
+                    continue;
+                }
+            }
+
             /* Decode the next character. */
 
             switch (parser->encoding)
             {
                 case YAML_UTF8_ENCODING:
 
-                    /*
-                     * Decode a UTF-8 character.  Check RFC 3629
-                     * (http://www.ietf.org/rfc/rfc3629.txt) for more details.
-                     *
-                     * The following table (taken from the RFC) is used for
-                     * decoding.
-                     *
-                     *    Char. number range |        UTF-8 octet sequence
-                     *      (hexadecimal)    |              (binary)
-                     *   --------------------+------------------------------------
-                     *   0000 0000-0000 007F | 0xxxxxxx
-                     *   0000 0080-0000 07FF | 110xxxxx 10xxxxxx
-                     *   0000 0800-0000 FFFF | 1110xxxx 10xxxxxx 10xxxxxx
-                     *   0001 0000-0010 FFFF | 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-                     *
-                     * Additionally, the characters in the range 0xD800-0xDFFF
-                     * are prohibited as they are reserved for use with UTF-16
-                     * surrogate pairs.
-                     */
-
-                    /* Determine the length of the UTF-8 sequence. */
-
-                    octet = parser->raw_buffer.pointer[0];
-                    width = (octet & 0x80) == 0x00 ? 1 :
-                            (octet & 0xE0) == 0xC0 ? 2 :
-                            (octet & 0xF0) == 0xE0 ? 3 :
-                            (octet & 0xF8) == 0xF0 ? 4 : 0;
-
-                    /* Check if the leading octet is valid. */
+                    width = yaml_parser_decode_utf8(parser,
+                            parser->raw_buffer.pointer, raw_unread, &value);
 
                     if (!width)
-                        return yaml_parser_set_reader_error(parser,
-                                "Invalid leading UTF-8 octet",
-                                parser->offset, octet);
+                        return 0;
 
                     /* Check if the raw buffer contains an incomplete character. */
 
@@ -247,48 +534,6 @@ yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
                         break;
                     }
 
-                    /* Decode the leading octet. */
-
-                    value = (octet & 0x80) == 0x00 ? octet & 0x7F :
-                            (octet & 0xE0) == 0xC0 ? octet & 0x1F :
-                            (octet & 0xF0) == 0xE0 ? octet & 0x0F :
-                            (octet & 0xF8) == 0xF0 ? octet & 0x07 : 0;
-
-                    /* Check and decode the trailing octets. */
-
-                    for (k = 1; k < width; k ++)
-                    {
-                        octet = parser->raw_buffer.pointer[k];
-
-                        /* Check if the octet is valid. */
-
-                        if ((octet & 0xC0) != 0x80)
-                            return yaml_parser_set_reader_error(parser,
-                                    "Invalid trailing UTF-8 octet",
-                                    parser->offset+k, octet);
-
-                        /* Decode the octet. */
-
-                        value = (value << 6) + (octet & 0x3F);
-                    }
-
-                    /* Check the length of the sequence against the value. */
-
-                    if (!((width == 1) ||
-                            (width == 2 && value >= 0x80) ||
-                            (width == 3 && value >= 0x800) ||
-                            (width == 4 && value >= 0x10000)))
-                        return yaml_parser_set_reader_error(parser,
-                                "Invalid length of a UTF-8 sequence",
-                                parser->offset, -1);
-
-                    /* Check the range of the value. */
-
-                    if ((value >= 0xD800 && value <= 0xDFFF) || value > 0x10FFFF)
-                        return yaml_parser_set_reader_error(parser,
-                                "Invalid Unicode character",
-                                parser->offset, value);
-
                     break;
                 
                 case YAML_UTF16LE_ENCODING:
@@ -396,18 +641,9 @@ yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
 
             if (incomplete) break;
 
-            /*
-             * Check if the character is in the allowed range:
-             *      #x9 | #xA | #xD | [#x20-#x7E]               (8 bit)
-             *      | #x85 | [#xA0-#xD7FF] | [#xE000-#xFFFD]    (16 bit)
-             *      | [#x10000-#x10FFFF]                        (32 bit)
-             */
-
-            if (! (value == 0x09 || value == 0x0A || value == 0x0D
-                        || (value >= 0x20 && value <= 0x7E)
-                        || (value == 0x85) || (value >= 0xA0 && value <= 0xD7FF)
-                        || (value >= 0xE000 && value <= 0xFFFD)
-                        || (value >= 0x10000 && value <= 0x10FFFF)))
+            /* Check if the character is in the allowed range. */
+
+            if (!IS_ALLOWED(value))
                 return yaml_parser_set_reader_error(parser,
                         "Control characters are not allowed",
                         parser->offset, value);
@@ -445,16 +681,185 @@ yaml_parser_update_buffer(yaml_parser_t *parser, size_t length)
             parser->unread ++;
         }
 
-        /* On EOF, put NUL into the buffer and return. */
+        /* On EOF, put NUL into the buffer. */
 
         if (parser->eof) {
             *(parser->buffer.last++) = '\0';
             parser->unread ++;
+        }
+
+        /* Pad the decoded characters. */
+
+        memset(parser->buffer.last, 0, INPUT_BUFFER_PADDING);
+
+        if (parser->eof)
             return 1;
+    }
+
+    return 1;
+}
+
+/*
+ * Check the characters of a UTF-8 input read in place from `pointer` up to
+ * `limit`.  The pointer, the input offset and the number of characters are
+ * advanced over them.
+ */
+
+static int
+yaml_parser_check_in_place(yaml_parser_t *parser, yaml_char_t **pointer,
+        const yaml_char_t *limit, size_t *count)
+{
+    const unsigned char *end = parser->input.string.end;
+
+    while (*pointer != limit)
+    {
+        unsigned int value = 0;
+        unsigned int width;
+        size_t run;
+
+        run = yaml_parser_scan_ascii(*pointer, limit - *pointer);
+        if (run) {
+            *pointer += run;
+            parser->offset += run;
+            *count += run;
+            continue;
         }
 
+        width = yaml_parser_decode_utf8(parser, *pointer, end - *pointer,
+                &value);
+        if (!width)
+            return 0;
+        if (width > (size_t)(end - *pointer))
+            return yaml_parser_set_reader_error(parser,
+                    "Incomplete UTF-8 octet sequence", parser->offset, -1);
+        if (!IS_ALLOWED(value))
+            return yaml_parser_set_reader_error(parser,
+                    "Control characters are not allowed", parser->offset,
+                    value);
+
+        *pointer += width;
+        parser->offset += width;
+        *count += 1;
     }
 
     return 1;
 }
 
+/*
+ * Ensure that the buffer contains at least `length` characters of a string
+ * input that is read in place.
+ *
+ * The working buffer points into the input string itself.  The characters are
+ * only checked, never decoded or copied, and `buffer.last` marks the end of the
+ * checked part.  It always stops at a line break, so that the scanner loops
+ * find the end of a run there, and `buffer.end` marks the last line break of
+ * the input.  When the scanner reaches the last line, the remaining characters
+ * are moved into a small allocated buffer so that they can be terminated with
+ * NUL.  A UTF-16 input is decoded as usual.
+ */
+
+static int
+yaml_parser_update_buffer_in_place(yaml_parser_t *parser, size_t length)
+{
+    const unsigned char *end = parser->input.string.end;
+
+    /* Determine the input encoding if it is not known yet. */
+
+    if (!parser->encoding) {
+        size_t size = end - parser->input.string.current;
+
+        if (size >= 2 && (!memcmp(parser->input.string.current, BOM_UTF16LE, 2)
+                    || !memcmp(parser->input.string.current, BOM_UTF16BE, 2))) {
+            parser->in_place = 0;
+            return yaml_parser_update_buffer(parser, length);
+        }
+        if (size >= 3 && !memcmp(parser->input.string.current, BOM_UTF8, 3)) {
+            parser->input.string.current += 3;
+            parser->offset += 3;
+        }
+        parser->encoding = YAML_UTF8_ENCODING;
+    }
+    else if (parser->encoding != YAML_UTF8_ENCODING) {
+        parser->in_place = 0;
+        return yaml_parser_update_buffer(parser, length);
+    }
+
+    /* Point the working buffer at the input string. */
+
+    if (!parser->buffer.start) {
+        const unsigned char *last_break = end;
+
+        while (last_break != parser->input.string.current
+                && last_break[-1] != '\n')
+            last_break --;
+        if (last_break != parser->input.string.current)
+            last_break --;
+        parser->buffer.start = (yaml_char_t *)parser->input.string.current;
+        parser->buffer.pointer = parser->buffer.start;
+        parser->buffer.last = parser->buffer.start;
+        parser->buffer.end = (yaml_char_t *)last_break;
+    }
+
+    /* Check the next chunk of the input up to a line break. */
+
+    if (parser->buffer.last != parser->buffer.end)
+    {
+        yaml_char_t *limit = parser->buffer.end;
+
+        if ((size_t)(limit - parser->buffer.last) > parser->buffer_size) {
+            limit = memchr(parser->buffer.last + parser->buffer_size, '\n',
+                    parser->buffer.end - parser->buffer.last
+                    - parser->buffer_size);
+            if (!limit)
+                limit = parser->buffer.end;
+        }
+        if (!yaml_parser_check_in_place(parser, &parser->buffer.last, limit,
+                    &parser->unread))
+            return 0;
+
+        /*
+         * Check the last line as well once it is within the reach of a chunk,
+         * so that an error in it is reported as early as with another input.
+         */
+
+        if (limit == parser->buffer.end) {
+            yaml_char_t *pointer = parser->buffer.end;
+            size_t offset = parser->offset;
+            size_t count = 0;
+            int checked = yaml_parser_check_in_place(parser, &pointer,
+                    (yaml_char_t *)end, &count);
+
+            parser->offset = offset;
+            if (!checked)
+                return 0;
+        }
+    }
+
+    /*
+     * On the last line, move the rest of the input into a buffer and put NUL
+     * into it.
+     */
+
+    if (parser->unread < length) {
+        yaml_char_t *rest = parser->buffer.pointer;
+        size_t size;
+
+        if (!yaml_parser_check_in_place(parser, &parser->buffer.last,
+                    (yaml_char_t *)end, &parser->unread))
+            return 0;
+
+        size = parser->buffer.last - parser->buffer.pointer;
+        parser->in_place = 0;
+        if (!BUFFER_INIT(parser, parser->buffer,
+                    size+1+INPUT_BUFFER_PADDING))
+            return 0;
+        memcpy(parser->buffer.start, rest, size);
+        parser->buffer.last += size;
+        *(parser->buffer.last++) = '\0';
+        memset(parser->buffer.last, 0, INPUT_BUFFER_PADDING);
+        parser->unread ++;
+        parser->eof = 1;
+    }
+
+    return 1;
+}
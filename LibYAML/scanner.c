@@ -477,6 +477,10 @@
 
 #include "yaml_private.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /*
  * Ensure that the buffer contains the required number of characters.
  * Return 1 on success, 0 on failure (reader error or memory error).
@@ -487,30 +491,64 @@
         ? 1                                                                     \
         : yaml_parser_update_buffer(parser, (length)))
 
+/*
+ * Get the column of the current position.  The column is not counted while
+ * advancing but follows from the index of the first character of the line.
+ */
+
+#define COLUMN(parser)                                                          \
+    (parser->mark.index - parser->line_start)
+
+/*
+ * Get the mark of the current position with its column filled in.
+ */
+
+#define MARK(parser)                                                            \
+    (parser->mark.column = COLUMN(parser), parser->mark)
+
 /*
  * Advance the buffer pointer.
  */
 
 #define SKIP(parser)                                                            \
      (parser->mark.index ++,                                                    \
-      parser->mark.column ++,                                                   \
       parser->unread --,                                                        \
       parser->buffer.pointer += WIDTH(parser->buffer))
 
 #define SKIP_LINE(parser)                                                       \
      (IS_CRLF(parser->buffer) ?                                                 \
       (parser->mark.index += 2,                                                 \
-       parser->mark.column = 0,                                                 \
+       parser->line_start = parser->mark.index,                                 \
        parser->mark.line ++,                                                    \
        parser->unread -= 2,                                                     \
        parser->buffer.pointer += 2) :                                           \
       IS_BREAK(parser->buffer) ?                                                \
       (parser->mark.index ++,                                                   \
-       parser->mark.column = 0,                                                 \
+       parser->line_start = parser->mark.index,                                 \
        parser->mark.line ++,                                                    \
        parser->unread --,                                                       \
        parser->buffer.pointer += WIDTH(parser->buffer)) : 0)
 
+/*
+ * Advance the buffer pointer over a run of ASCII characters.
+ */
+
+#define SKIP_ASCII(parser,length)                                               \
+     (parser->mark.index += (length),                                           \
+      parser->unread -= (length),                                               \
+      parser->buffer.pointer += (length))
+
+/*
+ * Get the current position in an input string read in place.  At the end of
+ * the input, the reader moves the rest of it into a buffer of its own, which
+ * ends with a NUL character.
+ */
+
+#define INPUT_POINTER(parser)                                                   \
+    (parser->in_place ? parser->buffer.pointer                                  \
+     : (yaml_char_t *)parser->input.string.end                                  \
+         - (parser->buffer.last - 1 - parser->buffer.pointer))
+
 /*
  * Copy a character to a string buffer and advance pointers.
  */
@@ -519,7 +557,6 @@
      (STRING_EXTEND(parser,string) ?                                            \
          (COPY(string,parser->buffer),                                          \
           parser->mark.index ++,                                                \
-          parser->mark.column ++,                                               \
           parser->unread --,                                                    \
           1) : 0)
 
@@ -534,7 +571,7 @@
      (*((string).pointer++) = (yaml_char_t) '\n',                               \
       parser->buffer.pointer += 2,                                              \
       parser->mark.index += 2,                                                  \
-      parser->mark.column = 0,                                                  \
+      parser->line_start = parser->mark.index,                                  \
       parser->mark.line ++,                                                     \
       parser->unread -= 2) :                                                    \
      (CHECK_AT(parser->buffer,'\r',0)                                           \
@@ -542,7 +579,7 @@
      (*((string).pointer++) = (yaml_char_t) '\n',                               \
       parser->buffer.pointer ++,                                                \
       parser->mark.index ++,                                                    \
-      parser->mark.column = 0,                                                  \
+      parser->line_start = parser->mark.index,                                  \
       parser->mark.line ++,                                                     \
       parser->unread --) :                                                      \
      (CHECK_AT(parser->buffer,'\xC2',0)                                         \
@@ -550,7 +587,7 @@
      (*((string).pointer++) = (yaml_char_t) '\n',                               \
       parser->buffer.pointer += 2,                                              \
       parser->mark.index ++,                                                    \
-      parser->mark.column = 0,                                                  \
+      parser->line_start = parser->mark.index,                                  \
       parser->mark.line ++,                                                     \
       parser->unread --) :                                                      \
      (CHECK_AT(parser->buffer,'\xE2',0) &&                                      \
@@ -561,7 +598,7 @@
       *((string).pointer++) = *(parser->buffer.pointer++),                      \
       *((string).pointer++) = *(parser->buffer.pointer++),                      \
       parser->mark.index ++,                                                    \
-      parser->mark.column = 0,                                                  \
+      parser->line_start = parser->mark.index,                                  \
       parser->mark.line ++,                                                     \
       parser->unread --) : 0),                                                  \
     1) : 0)
@@ -591,6 +628,29 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser);
 static int
 yaml_parser_fetch_next_token(yaml_parser_t *parser);
 
+/*
+ * Pushed input.
+ */
+
+static void
+yaml_parser_save_checkpoint(yaml_parser_t *parser);
+
+static int
+yaml_parser_restore_checkpoint(yaml_parser_t *parser);
+
+static int
+yaml_parser_check_scalar(yaml_parser_t *parser, yaml_scalar_style_t style);
+
+static int
+yaml_parser_check_plain_scalar(yaml_parser_t *parser, yaml_string_t *input);
+
+static int
+yaml_parser_check_quoted_scalar(yaml_parser_t *parser, yaml_string_t *input,
+        int single);
+
+static int
+yaml_parser_check_block_scalar(yaml_parser_t *parser, yaml_string_t *input);
+
 /*
  * Potential simple keys.
  */
@@ -734,6 +794,14 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
 static int
 yaml_parser_scan_plain_scalar(yaml_parser_t *parser, yaml_token_t *token);
 
+static int
+yaml_parser_string_append(yaml_parser_t *parser, yaml_string_t *string,
+        const yaml_char_t *pointer, size_t length);
+
+static int
+yaml_parser_copy_span(yaml_parser_t *parser, yaml_string_t *string,
+        yaml_char_t **span, yaml_char_t *span_end);
+
 /*
  * Get the next token.
  */
@@ -754,16 +822,25 @@ yaml_parser_scan(yaml_parser_t *parser, yaml_token_t *token)
         return 1;
     }
 
+    /* Wait for the next chunk of a pushed input. */
+
+    if (parser->input_needed || (!parser->read_handler && !parser->push)) {
+        parser->input_needed = 1;
+        return 1;
+    }
+
     /* Ensure that the tokens queue contains enough tokens. */
 
     if (!parser->token_available) {
         if (!yaml_parser_fetch_more_tokens(parser))
-            return 0;
+            return parser->input_needed;
     }
 
     /* Fetch the next token from the queue. */
     
     *token = DEQUEUE(parser, parser->tokens);
+    token->arena = ARENA_USED(parser);
+    token->allocator = parser->allocator;
     parser->token_available = 0;
     parser->tokens_parsed ++;
 
@@ -786,7 +863,7 @@ yaml_parser_set_scanner_error(yaml_parser_t *parser, const char *context,
     parser->context = context;
     parser->context_mark = context_mark;
     parser->problem = problem;
-    parser->problem_mark = parser->mark;
+    parser->problem_mark = MARK(parser);
 
     return 0;
 }
@@ -811,7 +888,7 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser)
 
         need_more_tokens = 0;
 
-        if (parser->tokens.head == parser->tokens.tail)
+        if (QUEUE_EMPTY(parser, parser->tokens))
         {
             /* Queue is empty. */
 
@@ -821,18 +898,18 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser)
         {
             yaml_simple_key_t *simple_key;
 
-            /* Check if any potential simple key may occupy the head position. */
+            /*
+             * Check if any potential simple key may occupy the head position.
+             * The oldest one has the lowest token number.
+             */
 
             if (!yaml_parser_stale_simple_keys(parser))
                 return 0;
 
-            for (simple_key = parser->simple_keys.start;
-                    simple_key != parser->simple_keys.top; simple_key++) {
-                if (simple_key->possible
-                        && simple_key->token_number == parser->tokens_parsed) {
-                    need_more_tokens = 1;
-                    break;
-                }
+            simple_key = parser->simple_keys.start + parser->simple_keys_oldest;
+            if (simple_key != parser->simple_keys.top
+                    && simple_key->token_number == parser->tokens_parsed) {
+                need_more_tokens = 1;
             }
         }
 
@@ -844,7 +921,132 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser)
         /* Fetch the next token. */
 
         if (!yaml_parser_fetch_next_token(parser))
-            return 0;
+            return yaml_parser_restore_checkpoint(parser);
+    }
+
+    parser->token_available = 1;
+
+    return 1;
+}
+
+/*
+ * Save the scanner state before fetching a token from a pushed input.
+ *
+ * Fetching a token is not resumable: if the input runs out in the middle of a
+ * token, the scanner returns to the checkpoint and scans the token again when
+ * more input is fed.  The state changes that precede a token (the skipped
+ * whitespaces, comments and closed indentation levels) are kept, so the
+ * checkpoint is saved twice: at the start and right before the token.  A
+ * scalar, which may be long, is only scanned once it is complete; see
+ * yaml_parser_check_scalar().
+ */
+
+static void
+yaml_parser_save_checkpoint(yaml_parser_t *parser)
+{
+    if (!parser->push)
+        return;
+
+    parser->checkpoint.pointer = parser->buffer.pointer;
+    parser->checkpoint.unread = parser->unread;
+    parser->checkpoint.mark = MARK(parser);
+    parser->checkpoint.flow_level = parser->flow_level;
+    parser->checkpoint.tokens = QUEUE_LENGTH(parser, parser->tokens);
+    parser->checkpoint.indents = parser->indents.top - parser->indents.start;
+    parser->checkpoint.indent = parser->indent;
+    parser->checkpoint.simple_key_allowed = parser->simple_key_allowed;
+    parser->checkpoint.simple_keys =
+        parser->simple_keys.top - parser->simple_keys.start;
+    if (parser->checkpoint.simple_keys) {
+        parser->checkpoint.simple_key = *(parser->simple_keys.top-1);
+    }
+}
+
+/*
+ * Return to the checkpoint if the pushed input has run out.  Return 0.
+ *
+ * Only the tokens without data (BLOCK-END) may be queued between the
+ * checkpoint and the end of the input, so they are dropped as is.  The
+ * characters decoded since the checkpoint are kept in the buffer.
+ */
+
+static int
+yaml_parser_restore_checkpoint(yaml_parser_t *parser)
+{
+    if (!parser->input_needed)
+        return 0;
+
+    parser->buffer.pointer = parser->checkpoint.pointer;
+    parser->unread += parser->mark.index - parser->checkpoint.mark.index;
+    parser->mark = parser->checkpoint.mark;
+    parser->line_start = parser->mark.index - parser->mark.column;
+    parser->flow_level = parser->checkpoint.flow_level;
+    parser->tokens.tail = parser->tokens.head + parser->checkpoint.tokens;
+    parser->indents.top = parser->indents.start + parser->checkpoint.indents;
+    parser->indent = parser->checkpoint.indent;
+    parser->simple_key_allowed = parser->checkpoint.simple_key_allowed;
+    parser->simple_keys.top =
+        parser->simple_keys.start + parser->checkpoint.simple_keys;
+    if (parser->checkpoint.simple_keys) {
+        *(parser->simple_keys.top-1) = parser->checkpoint.simple_key;
+    }
+    parser->simple_keys_oldest = 0;
+
+    return 0;
+}
+
+/*
+ * Ensure that the tokens queue contains every token the Parser needs to
+ * produce the next event, so that a pushed input never runs out in the middle
+ * of an event.
+ *
+ * The tokens must also be settled, that is, no KEY token may still be
+ * inserted before them.
+ */
+
+YAML_DECLARE(int)
+yaml_parser_fetch_event_tokens(yaml_parser_t *parser)
+{
+    while (1)
+    {
+        size_t queued = QUEUE_LENGTH(parser, parser->tokens);
+        size_t needed = yaml_parser_event_lookahead(parser);
+        yaml_simple_key_t *simple_key;
+        int need_more_tokens = 0;
+
+        if (queued < needed && !(queued
+                    && QUEUE_AT(parser, parser->tokens, queued-1).type
+                        == YAML_STREAM_END_TOKEN))
+        {
+            need_more_tokens = 1;
+        }
+        else
+        {
+            /*
+             * Check if any potential simple key may occupy these positions.
+             * The oldest one has the lowest token number.
+             */
+
+            if (!yaml_parser_stale_simple_keys(parser))
+                return 0;
+
+            simple_key = parser->simple_keys.start + parser->simple_keys_oldest;
+            if (simple_key != parser->simple_keys.top
+                    && simple_key->token_number - parser->tokens_parsed
+                        < needed) {
+                need_more_tokens = 1;
+            }
+        }
+
+        /* We are finished. */
+
+        if (!need_more_tokens)
+            break;
+
+        /* Fetch the next token. */
+
+        if (!yaml_parser_fetch_next_token(parser))
+            return yaml_parser_restore_checkpoint(parser);
     }
 
     parser->token_available = 1;
@@ -859,6 +1061,8 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser)
 static int
 yaml_parser_fetch_next_token(yaml_parser_t *parser)
 {
+    yaml_parser_save_checkpoint(parser);
+
     /* Ensure that the buffer is initialized. */
 
     if (!CACHE(parser, 1))
@@ -881,9 +1085,11 @@ yaml_parser_fetch_next_token(yaml_parser_t *parser)
 
     /* Check the indentation level against the current column. */
 
-    if (!yaml_parser_unroll_indent(parser, parser->mark.column))
+    if (!yaml_parser_unroll_indent(parser, COLUMN(parser)))
         return 0;
 
+    yaml_parser_save_checkpoint(parser);
+
     /*
      * Ensure that the buffer contains at least 4 characters.  4 is the length
      * of the longest indicators ('--- ' and '... ').
@@ -899,12 +1105,12 @@ yaml_parser_fetch_next_token(yaml_parser_t *parser)
 
     /* Is it a directive? */
 
-    if (parser->mark.column == 0 && CHECK(parser->buffer, '%'))
+    if (COLUMN(parser) == 0 && CHECK(parser->buffer, '%'))
         return yaml_parser_fetch_directive(parser);
 
     /* Is it the document start indicator? */
 
-    if (parser->mark.column == 0
+    if (COLUMN(parser) == 0
             && CHECK_AT(parser->buffer, '-', 0)
             && CHECK_AT(parser->buffer, '-', 1)
             && CHECK_AT(parser->buffer, '-', 2)
@@ -914,7 +1120,7 @@ yaml_parser_fetch_next_token(yaml_parser_t *parser)
 
     /* Is it the document end indicator? */
 
-    if (parser->mark.column == 0
+    if (COLUMN(parser) == 0
             && CHECK_AT(parser->buffer, '.', 0)
             && CHECK_AT(parser->buffer, '.', 1)
             && CHECK_AT(parser->buffer, '.', 2)
@@ -1043,13 +1249,17 @@ yaml_parser_fetch_next_token(yaml_parser_t *parser)
      */
 
     return yaml_parser_set_scanner_error(parser,
-            "while scanning for the next token", parser->mark,
+            "while scanning for the next token", MARK(parser),
             "found character that cannot start any token");
 }
 
 /*
  * Check the list of potential simple keys and remove the positions that
  * cannot contain simple keys anymore.
+ *
+ * A simple key is only saved at the top of the stack, so the possible keys
+ * are older the lower they are.  The stale ones are always at the bottom, and
+ * the check stops at the oldest key that is still possible.
  */
 
 static int
@@ -1057,11 +1267,15 @@ yaml_parser_stale_simple_keys(yaml_parser_t *parser)
 {
     yaml_simple_key_t *simple_key;
 
-    /* Check for a potential simple key for each flow level. */
+    /* Check for a potential simple key from the oldest one. */
 
-    for (simple_key = parser->simple_keys.start;
-            simple_key != parser->simple_keys.top; simple_key ++)
+    for (simple_key = parser->simple_keys.start + parser->simple_keys_oldest;
+            simple_key != parser->simple_keys.top;
+            simple_key ++, parser->simple_keys_oldest ++)
     {
+        if (!simple_key->possible)
+            continue;
+
         /*
          * The specification requires that a simple key
          *
@@ -1069,9 +1283,8 @@ yaml_parser_stale_simple_keys(yaml_parser_t *parser)
          *  - is shorter than 1024 characters.
          */
 
-        if (simple_key->possible
-                && (simple_key->mark.line < parser->mark.line
-                    || simple_key->mark.index+1024 < parser->mark.index)) {
+        if (simple_key->mark.line < parser->mark.line
+                || simple_key->mark.index+1024 < parser->mark.index) {
 
             /* Check if the potential simple key to be removed is required. */
 
@@ -1083,6 +1296,8 @@ yaml_parser_stale_simple_keys(yaml_parser_t *parser)
 
             simple_key->possible = 0;
         }
+        else
+            break;
     }
 
     return 1;
@@ -1103,7 +1318,7 @@ yaml_parser_save_simple_key(yaml_parser_t *parser)
      */
 
     int required = (!parser->flow_level
-            && parser->indent == (int)parser->mark.column);
+            && parser->indent == (int)COLUMN(parser));
 
     /*
      * A simple key is required only when it is the first token in the current
@@ -1119,13 +1334,18 @@ yaml_parser_save_simple_key(yaml_parser_t *parser)
     if (parser->simple_key_allowed)
     {
         yaml_simple_key_t simple_key = { 1, required,
-            parser->tokens_parsed + parser->tokens.tail - parser->tokens.head,
+            parser->tokens_parsed + QUEUE_LENGTH(parser, parser->tokens),
             { 0, 0, 0 } };
-        simple_key.mark = parser->mark;
+        simple_key.mark = MARK(parser);
 
         if (!yaml_parser_remove_simple_key(parser)) return 0;
 
         *(parser->simple_keys.top-1) = simple_key;
+
+        if (parser->simple_keys_oldest
+                > (size_t)(parser->simple_keys.top-1 - parser->simple_keys.start))
+            parser->simple_keys_oldest =
+                parser->simple_keys.top-1 - parser->simple_keys.start;
     }
 
     return 1;
@@ -1191,6 +1411,10 @@ yaml_parser_decrease_flow_level(yaml_parser_t *parser)
     if (parser->flow_level) {
         parser->flow_level --;
         dummy_key = POP(parser, parser->simple_keys);
+        if (parser->simple_keys_oldest
+                > (size_t)(parser->simple_keys.top - parser->simple_keys.start))
+            parser->simple_keys_oldest =
+                parser->simple_keys.top - parser->simple_keys.start;
     }
 
     return 1;
@@ -1267,7 +1491,7 @@ yaml_parser_unroll_indent(yaml_parser_t *parser, int column)
     {
         /* Create a token and append it to the queue. */
 
-        TOKEN_INIT(token, YAML_BLOCK_END_TOKEN, parser->mark, parser->mark);
+        TOKEN_INIT(token, YAML_BLOCK_END_TOKEN, MARK(parser), MARK(parser));
 
         if (!ENQUEUE(parser, parser->tokens, token))
             return 0;
@@ -1310,7 +1534,7 @@ yaml_parser_fetch_stream_start(yaml_parser_t *parser)
     /* Create the STREAM-START token and append it to the queue. */
 
     STREAM_START_TOKEN_INIT(token, parser->encoding,
-            parser->mark, parser->mark);
+            MARK(parser), MARK(parser));
 
     if (!ENQUEUE(parser, parser->tokens, token))
         return 0;
@@ -1329,8 +1553,8 @@ yaml_parser_fetch_stream_end(yaml_parser_t *parser)
 
     /* Force new line. */
 
-    if (parser->mark.column != 0) {
-        parser->mark.column = 0;
+    if (COLUMN(parser) != 0) {
+        parser->line_start = parser->mark.index;
         parser->mark.line ++;
     }
 
@@ -1348,7 +1572,7 @@ yaml_parser_fetch_stream_end(yaml_parser_t *parser)
 
     /* Create the STREAM-END token and append it to the queue. */
 
-    STREAM_END_TOKEN_INIT(token, parser->mark, parser->mark);
+    STREAM_END_TOKEN_INIT(token, MARK(parser), MARK(parser));
 
     if (!ENQUEUE(parser, parser->tokens, token))
         return 0;
@@ -1385,7 +1609,7 @@ yaml_parser_fetch_directive(yaml_parser_t *parser)
     /* Append the token to the queue. */
 
     if (!ENQUEUE(parser, parser->tokens, token)) {
-        yaml_token_delete(&token);
+        TOKEN_DEL(parser, token);
         return 0;
     }
 
@@ -1417,13 +1641,13 @@ yaml_parser_fetch_document_indicator(yaml_parser_t *parser,
 
     /* Consume the token. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
 
     SKIP(parser);
     SKIP(parser);
     SKIP(parser);
 
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create the DOCUMENT-START or DOCUMENT-END token. */
 
@@ -1464,9 +1688,9 @@ yaml_parser_fetch_flow_collection_start(yaml_parser_t *parser,
 
     /* Consume the token. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
     SKIP(parser);
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create the FLOW-SEQUENCE-START of FLOW-MAPPING-START token. */
 
@@ -1507,9 +1731,9 @@ yaml_parser_fetch_flow_collection_end(yaml_parser_t *parser,
 
     /* Consume the token. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
     SKIP(parser);
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create the FLOW-SEQUENCE-END of FLOW-MAPPING-END token. */
 
@@ -1544,9 +1768,9 @@ yaml_parser_fetch_flow_entry(yaml_parser_t *parser)
 
     /* Consume the token. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
     SKIP(parser);
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create the FLOW-ENTRY token and append it to the queue. */
 
@@ -1575,14 +1799,14 @@ yaml_parser_fetch_block_entry(yaml_parser_t *parser)
         /* Check if we are allowed to start a new entry. */
 
         if (!parser->simple_key_allowed) {
-            return yaml_parser_set_scanner_error(parser, NULL, parser->mark,
+            return yaml_parser_set_scanner_error(parser, NULL, MARK(parser),
                     "block sequence entries are not allowed in this context");
         }
 
         /* Add the BLOCK-SEQUENCE-START token if needed. */
 
-        if (!yaml_parser_roll_indent(parser, parser->mark.column, -1,
-                    YAML_BLOCK_SEQUENCE_START_TOKEN, parser->mark))
+        if (!yaml_parser_roll_indent(parser, COLUMN(parser), -1,
+                    YAML_BLOCK_SEQUENCE_START_TOKEN, MARK(parser)))
             return 0;
     }
     else
@@ -1605,9 +1829,9 @@ yaml_parser_fetch_block_entry(yaml_parser_t *parser)
 
     /* Consume the token. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
     SKIP(parser);
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create the BLOCK-ENTRY token and append it to the queue. */
 
@@ -1636,14 +1860,14 @@ yaml_parser_fetch_key(yaml_parser_t *parser)
         /* Check if we are allowed to start a new key (not nessesary simple). */
 
         if (!parser->simple_key_allowed) {
-            return yaml_parser_set_scanner_error(parser, NULL, parser->mark,
+            return yaml_parser_set_scanner_error(parser, NULL, MARK(parser),
                     "mapping keys are not allowed in this context");
         }
 
         /* Add the BLOCK-MAPPING-START token if needed. */
 
-        if (!yaml_parser_roll_indent(parser, parser->mark.column, -1,
-                    YAML_BLOCK_MAPPING_START_TOKEN, parser->mark))
+        if (!yaml_parser_roll_indent(parser, COLUMN(parser), -1,
+                    YAML_BLOCK_MAPPING_START_TOKEN, MARK(parser)))
             return 0;
     }
 
@@ -1658,9 +1882,9 @@ yaml_parser_fetch_key(yaml_parser_t *parser)
 
     /* Consume the token. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
     SKIP(parser);
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create the KEY token and append it to the queue. */
 
@@ -1722,14 +1946,14 @@ yaml_parser_fetch_value(yaml_parser_t *parser)
             /* Check if we are allowed to start a complex value. */
 
             if (!parser->simple_key_allowed) {
-                return yaml_parser_set_scanner_error(parser, NULL, parser->mark,
+                return yaml_parser_set_scanner_error(parser, NULL, MARK(parser),
                         "mapping values are not allowed in this context");
             }
 
             /* Add the BLOCK-MAPPING-START token if needed. */
 
-            if (!yaml_parser_roll_indent(parser, parser->mark.column, -1,
-                        YAML_BLOCK_MAPPING_START_TOKEN, parser->mark))
+            if (!yaml_parser_roll_indent(parser, COLUMN(parser), -1,
+                        YAML_BLOCK_MAPPING_START_TOKEN, MARK(parser)))
                 return 0;
         }
 
@@ -1740,9 +1964,9 @@ yaml_parser_fetch_value(yaml_parser_t *parser)
 
     /* Consume the token. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
     SKIP(parser);
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create the VALUE token and append it to the queue. */
 
@@ -1778,7 +2002,7 @@ yaml_parser_fetch_anchor(yaml_parser_t *parser, yaml_token_type_t type)
         return 0;
 
     if (!ENQUEUE(parser, parser->tokens, token)) {
-        yaml_token_delete(&token);
+        TOKEN_DEL(parser, token);
         return 0;
     }
     return 1;
@@ -1808,7 +2032,7 @@ yaml_parser_fetch_tag(yaml_parser_t *parser)
         return 0;
 
     if (!ENQUEUE(parser, parser->tokens, token)) {
-        yaml_token_delete(&token);
+        TOKEN_DEL(parser, token);
         return 0;
     }
 
@@ -1824,6 +2048,12 @@ yaml_parser_fetch_block_scalar(yaml_parser_t *parser, int literal)
 {
     yaml_token_t token;
 
+    /* Wait until a pushed input holds the whole scalar. */
+
+    if (!yaml_parser_check_scalar(parser,
+                literal ? YAML_LITERAL_SCALAR_STYLE : YAML_FOLDED_SCALAR_STYLE))
+        return 0;
+
     /* Remove any potential simple keys. */
 
     if (!yaml_parser_remove_simple_key(parser))
@@ -1839,7 +2069,7 @@ yaml_parser_fetch_block_scalar(yaml_parser_t *parser, int literal)
         return 0;
 
     if (!ENQUEUE(parser, parser->tokens, token)) {
-        yaml_token_delete(&token);
+        TOKEN_DEL(parser, token);
         return 0;
     }
 
@@ -1855,6 +2085,12 @@ yaml_parser_fetch_flow_scalar(yaml_parser_t *parser, int single)
 {
     yaml_token_t token;
 
+    /* Wait until a pushed input holds the whole scalar. */
+
+    if (!yaml_parser_check_scalar(parser, single
+                ? YAML_SINGLE_QUOTED_SCALAR_STYLE : YAML_DOUBLE_QUOTED_SCALAR_STYLE))
+        return 0;
+
     /* A plain scalar could be a simple key. */
 
     if (!yaml_parser_save_simple_key(parser))
@@ -1870,7 +2106,7 @@ yaml_parser_fetch_flow_scalar(yaml_parser_t *parser, int single)
         return 0;
 
     if (!ENQUEUE(parser, parser->tokens, token)) {
-        yaml_token_delete(&token);
+        TOKEN_DEL(parser, token);
         return 0;
     }
 
@@ -1886,6 +2122,11 @@ yaml_parser_fetch_plain_scalar(yaml_parser_t *parser)
 {
     yaml_token_t token;
 
+    /* Wait until a pushed input holds the whole scalar. */
+
+    if (!yaml_parser_check_scalar(parser, YAML_PLAIN_SCALAR_STYLE))
+        return 0;
+
     /* A plain scalar could be a simple key. */
 
     if (!yaml_parser_save_simple_key(parser))
@@ -1901,7 +2142,7 @@ yaml_parser_fetch_plain_scalar(yaml_parser_t *parser)
         return 0;
 
     if (!ENQUEUE(parser, parser->tokens, token)) {
-        yaml_token_delete(&token);
+        TOKEN_DEL(parser, token);
         return 0;
     }
 
@@ -1915,6 +2156,8 @@ yaml_parser_fetch_plain_scalar(yaml_parser_t *parser)
 static int
 yaml_parser_scan_to_next_token(yaml_parser_t *parser)
 {
+    int tabs;
+
     /* Until the next token is not find. */
 
     while (1)
@@ -1923,7 +2166,7 @@ yaml_parser_scan_to_next_token(yaml_parser_t *parser)
 
         if (!CACHE(parser, 1)) return 0;
 
-        if (parser->mark.column == 0 && IS_BOM(parser->buffer))
+        if (COLUMN(parser) == 0 && IS_BOM(parser->buffer))
             SKIP(parser);
 
         /*
@@ -1934,14 +2177,21 @@ yaml_parser_scan_to_next_token(yaml_parser_t *parser)
          *  - in the flow context;
          *  - in the block context, but not at the beginning of the line or
          *  after '-', '?', or ':' (complex value).  
+         *
+         * A run of blanks or comment characters ends at the padding of the
+         * buffer or at a line break, so the cache is checked only after it.
          */
 
         if (!CACHE(parser, 1)) return 0;
 
+        tabs = (parser->flow_level || !parser->simple_key_allowed);
+
         while (CHECK(parser->buffer,' ') ||
-                ((parser->flow_level || !parser->simple_key_allowed) &&
-                 CHECK(parser->buffer, '\t'))) {
-            SKIP(parser);
+                (tabs && CHECK(parser->buffer, '\t'))) {
+            do {
+                SKIP(parser);
+            } while (CHECK(parser->buffer,' ') ||
+                    (tabs && CHECK(parser->buffer, '\t')));
             if (!CACHE(parser, 1)) return 0;
         }
 
@@ -1949,7 +2199,9 @@ yaml_parser_scan_to_next_token(yaml_parser_t *parser)
 
         if (CHECK(parser->buffer, '#')) {
             while (!IS_BREAKZ(parser->buffer)) {
-                SKIP(parser);
+                do {
+                    SKIP(parser);
+                } while (!IS_BREAKZ(parser->buffer));
                 if (!CACHE(parser, 1)) return 0;
             }
         }
@@ -1998,7 +2250,7 @@ yaml_parser_scan_directive(yaml_parser_t *parser, yaml_token_t *token)
 
     /* Eat '%'. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
 
     SKIP(parser);
 
@@ -2017,7 +2269,7 @@ yaml_parser_scan_directive(yaml_parser_t *parser, yaml_token_t *token)
                     &major, &minor))
             goto error;
 
-        end_mark = parser->mark;
+        end_mark = MARK(parser);
 
         /* Create a VERSION-DIRECTIVE token. */
 
@@ -2035,7 +2287,7 @@ yaml_parser_scan_directive(yaml_parser_t *parser, yaml_token_t *token)
                     &handle, &prefix))
             goto error;
 
-        end_mark = parser->mark;
+        end_mark = MARK(parser);
 
         /* Create a TAG-DIRECTIVE token. */
 
@@ -2083,14 +2335,14 @@ yaml_parser_scan_directive(yaml_parser_t *parser, yaml_token_t *token)
         SKIP_LINE(parser);
     }
 
-    yaml_free(name);
+    ARENA_FREE(parser, name);
 
     return 1;
 
 error:
-    yaml_free(prefix);
-    yaml_free(handle);
-    yaml_free(name);
+    ARENA_FREE(parser, prefix);
+    ARENA_FREE(parser, handle);
+    ARENA_FREE(parser, name);
     return 0;
 }
 
@@ -2308,8 +2560,8 @@ yaml_parser_scan_tag_directive_value(yaml_parser_t *parser,
     return 1;
 
 error:
-    yaml_free(handle_value);
-    yaml_free(prefix_value);
+    ARENA_FREE(parser, handle_value);
+    ARENA_FREE(parser, prefix_value);
     return 0;
 }
 
@@ -2325,7 +2577,7 @@ yaml_parser_scan_anchor(yaml_parser_t *parser, yaml_token_t *token,
 
     /* Eat the indicator character. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
 
     SKIP(parser);
 
@@ -2339,7 +2591,7 @@ yaml_parser_scan_anchor(yaml_parser_t *parser, yaml_token_t *token,
         length ++;
     }
 
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /*
      * Check if length of the anchor is greater than 0 and it is followed by
@@ -2386,7 +2638,7 @@ yaml_parser_scan_tag(yaml_parser_t *parser, yaml_token_t *token)
     yaml_char_t *suffix = NULL;
     yaml_mark_t start_mark, end_mark;
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
 
     /* Check if the tag is in the canonical form. */
 
@@ -2396,7 +2648,7 @@ yaml_parser_scan_tag(yaml_parser_t *parser, yaml_token_t *token)
     {
         /* Set the handle to '' */
 
-        handle = yaml_malloc(1);
+        handle = ARENA_MALLOC(parser, 1);
         if (!handle) goto error;
         handle[0] = '\0';
 
@@ -2447,8 +2699,8 @@ yaml_parser_scan_tag(yaml_parser_t *parser, yaml_token_t *token)
 
             /* Set the handle to '!'. */
 
-            yaml_free(handle);
-            handle = yaml_malloc(2);
+            ARENA_FREE(parser, handle);
+            handle = ARENA_MALLOC(parser, 2);
             if (!handle) goto error;
             handle[0] = '!';
             handle[1] = '\0';
@@ -2476,7 +2728,7 @@ yaml_parser_scan_tag(yaml_parser_t *parser, yaml_token_t *token)
         goto error;
     }
 
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create a token. */
 
@@ -2485,8 +2737,8 @@ yaml_parser_scan_tag(yaml_parser_t *parser, yaml_token_t *token)
     return 1;
 
 error:
-    yaml_free(handle);
-    yaml_free(suffix);
+    ARENA_FREE(parser, handle);
+    ARENA_FREE(parser, suffix);
     return 0;
 }
 
@@ -2573,7 +2825,8 @@ yaml_parser_scan_tag_uri(yaml_parser_t *parser, int directive,
     /* Resize the string to include the head. */
 
     while (string.end - string.start <= (int)length) {
-        if (!yaml_string_extend(&string.start, &string.pointer, &string.end)) {
+        if (!yaml_string_extend(parser,
+                    &string.start, &string.pointer, &string.end)) {
             parser->error = YAML_MEMORY_ERROR;
             goto error;
         }
@@ -2718,6 +2971,59 @@ yaml_parser_scan_uri_escapes(yaml_parser_t *parser, int directive,
     return 1;
 }
 
+/*
+ * Find the run of characters that a block scalar line consumes without
+ * further checks.
+ *
+ * Return the length of the longest prefix of the octets that consists of the
+ * characters [#x20-#x7E] and tabs.  Such a character never ends the line, so
+ * the run can be copied at once.  Any other octet, a line break, NUL or a
+ * part of a non-ASCII character, is left to the character loop.
+ */
+
+#define IS_LINE_SAFE(octet)                                                     \
+    (((octet) >= 0x20 && (octet) < 0x7F) || (octet) == '\t')
+
+static size_t
+yaml_parser_scan_line_run(const unsigned char *pointer, size_t length)
+{
+    size_t k = 0;
+
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    while (k + 16 <= length)
+    {
+        __m128i octets = _mm_loadu_si128((const __m128i *)(pointer + k));
+
+        /* Octets above 0x7F are negative and fail the signed comparison. */
+
+        __m128i safe = _mm_or_si128(_mm_andnot_si128(
+                    _mm_cmpeq_epi8(octets, del),
+                    _mm_cmpgt_epi8(octets, space)),
+                _mm_cmpeq_epi8(octets, tab));
+        int mask = _mm_movemask_epi8(safe);
+
+        if (mask != 0xFFFF) {
+            while (mask & 1) {
+                mask >>= 1;
+                k ++;
+            }
+            return k;
+        }
+
+        k += 16;
+    }
+#endif
+
+    while (k < length && IS_LINE_SAFE(pointer[k]))
+        k ++;
+
+    return k;
+}
+
 /*
  * Scan a block scalar.
  */
@@ -2743,7 +3049,7 @@ yaml_parser_scan_block_scalar(yaml_parser_t *parser, yaml_token_t *token,
 
     /* Eat the indicator '|' or '>'. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
 
     SKIP(parser);
 
@@ -2837,7 +3143,7 @@ yaml_parser_scan_block_scalar(yaml_parser_t *parser, yaml_token_t *token,
         SKIP_LINE(parser);
     }
 
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Set the intendation level if it was specified. */
 
@@ -2854,7 +3160,7 @@ yaml_parser_scan_block_scalar(yaml_parser_t *parser, yaml_token_t *token,
 
     if (!CACHE(parser, 1)) goto error;
 
-    while ((int)parser->mark.column == indent && !IS_Z(parser->buffer))
+    while ((int)COLUMN(parser) == indent && !IS_Z(parser->buffer))
     {
         /*
          * We are at the beginning of a non-empty line.
@@ -2892,10 +3198,23 @@ yaml_parser_scan_block_scalar(yaml_parser_t *parser, yaml_token_t *token,
 
         leading_blank = IS_BLANK(parser->buffer);
 
-        /* Consume the current line. */
+        /*
+         * Consume the current line.  The runs of ASCII characters are copied
+         * at once, the other characters one by one.
+         */
 
         while (!IS_BREAKZ(parser->buffer)) {
-            if (!READ(parser, string)) goto error;
+            size_t length = yaml_parser_scan_line_run(parser->buffer.pointer,
+                    parser->unread);
+
+            if (length > 1) {
+                if (!yaml_parser_string_append(parser, &string,
+                            parser->buffer.pointer, length)) goto error;
+                SKIP_ASCII(parser, length);
+            }
+            else {
+                if (!READ(parser, string)) goto error;
+            }
             if (!CACHE(parser, 1)) goto error;
         }
 
@@ -2951,28 +3270,38 @@ yaml_parser_scan_block_scalar_breaks(yaml_parser_t *parser,
 {
     int max_indent = 0;
 
-    *end_mark = parser->mark;
+    *end_mark = MARK(parser);
 
     /* Eat the intendation spaces and line breaks. */
 
     while (1)
     {
-        /* Eat the intendation spaces. */
+        /*
+         * Eat the intendation spaces.  The spaces up to the indentation level
+         * that are in the buffer are skipped at once.
+         */
 
         if (!CACHE(parser, 1)) return 0;
 
-        while ((!*indent || (int)parser->mark.column < *indent)
+        while ((!*indent || (int)COLUMN(parser) < *indent)
                 && IS_SPACE(parser->buffer)) {
-            SKIP(parser);
+            size_t length = 1;
+            size_t limit = *indent ? *indent - COLUMN(parser) : parser->unread;
+
+            if (limit > parser->unread)
+                limit = parser->unread;
+            while (length < limit && parser->buffer.pointer[length] == ' ')
+                length ++;
+            SKIP_ASCII(parser, length);
             if (!CACHE(parser, 1)) return 0;
         }
 
-        if ((int)parser->mark.column > max_indent)
-            max_indent = (int)parser->mark.column;
+        if ((int)COLUMN(parser) > max_indent)
+            max_indent = (int)COLUMN(parser);
 
         /* Check for a tab character messing the intendation. */
 
-        if ((!*indent || (int)parser->mark.column < *indent)
+        if ((!*indent || (int)COLUMN(parser) < *indent)
                 && IS_TAB(parser->buffer)) {
             return yaml_parser_set_scanner_error(parser, "while scanning a block scalar",
                     start_mark, "found a tab character where an intendation space is expected");
@@ -2986,7 +3315,7 @@ yaml_parser_scan_block_scalar_breaks(yaml_parser_t *parser,
 
         if (!CACHE(parser, 2)) return 0;
         if (!READ_LINE(parser, *breaks)) return 0;
-        *end_mark = parser->mark;
+        *end_mark = MARK(parser);
     }
 
     /* Determine the indentation level if needed. */
@@ -3002,6 +3331,63 @@ yaml_parser_scan_block_scalar_breaks(yaml_parser_t *parser,
    return 1; 
 }
 
+/*
+ * Find the run of characters that a quoted scalar consumes without further
+ * checks.
+ *
+ * Return the length of the longest prefix of the octets that consists of the
+ * characters [#x20-#x7E] except the quote and, in a double-quoted scalar, '\\'.
+ * The caller drops the trailing spaces of the run, as the whitespaces before
+ * a line break are folded.
+ */
+
+#define IS_QUOTED_SAFE(octet,single)                                            \
+    ((octet) >= 0x20 && (octet) < 0x7F                                          \
+     && (octet) != ((single) ? '\'' : '"')                                      \
+     && ((single) || (octet) != '\\'))
+
+static size_t
+yaml_parser_scan_quoted_run(const unsigned char *pointer, size_t length,
+        int single)
+{
+    size_t k = 0;
+
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i quote = _mm_set1_epi8(single ? '\'' : '"');
+    const __m128i backslash = _mm_set1_epi8(single ? '\'' : '\\');
+
+    while (k + 16 <= length)
+    {
+        __m128i octets = _mm_loadu_si128((const __m128i *)(pointer + k));
+
+        /* Octets above 0x7F are negative and fail the signed comparison. */
+
+        __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(octets, del),
+                _mm_or_si128(_mm_cmpeq_epi8(octets, quote),
+                    _mm_cmpeq_epi8(octets, backslash)));
+        int mask = _mm_movemask_epi8(_mm_andnot_si128(stop,
+                    _mm_cmpgt_epi8(octets, space)));
+
+        if (mask != 0xFFFF) {
+            while (mask & 1) {
+                mask >>= 1;
+                k ++;
+            }
+            return k;
+        }
+
+        k += 16;
+    }
+#endif
+
+    while (k < length && IS_QUOTED_SAFE(pointer[k], single))
+        k ++;
+
+    return k;
+}
+
 /*
  * Scan a quoted scalar.
  */
@@ -3016,19 +3402,32 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
     yaml_string_t leading_break = NULL_STRING;
     yaml_string_t trailing_breaks = NULL_STRING;
     yaml_string_t whitespaces = NULL_STRING;
+    yaml_char_t *span = NULL;
+    yaml_char_t *span_end = NULL;
     int leading_blanks;
 
-    if (!STRING_INIT(parser, string, INITIAL_STRING_SIZE)) goto error;
     if (!STRING_INIT(parser, leading_break, INITIAL_STRING_SIZE)) goto error;
     if (!STRING_INIT(parser, trailing_breaks, INITIAL_STRING_SIZE)) goto error;
     if (!STRING_INIT(parser, whitespaces, INITIAL_STRING_SIZE)) goto error;
 
     /* Eat the left quote. */
 
-    start_mark = parser->mark;
+    start_mark = MARK(parser);
 
     SKIP(parser);
 
+    /*
+     * An input read in place may lend the value until it needs to be folded
+     * or unescaped.
+     */
+
+    if (parser->in_place && parser->borrow_scalars) {
+        span = span_end = INPUT_POINTER(parser);
+    }
+    else {
+        if (!STRING_INIT(parser, string, INITIAL_STRING_SIZE)) goto error;
+    }
+
     /* Consume the content of the quoted scalar. */
 
     while (1)
@@ -3037,7 +3436,7 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
 
         if (!CACHE(parser, 4)) goto error;
 
-        if (parser->mark.column == 0 &&
+        if (COLUMN(parser) == 0 &&
             ((CHECK_AT(parser->buffer, '-', 0) &&
               CHECK_AT(parser->buffer, '-', 1) &&
               CHECK_AT(parser->buffer, '-', 2)) ||
@@ -3072,6 +3471,8 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
             if (single && CHECK_AT(parser->buffer, '\'', 0)
                     && CHECK_AT(parser->buffer, '\'', 1))
             {
+                if (span && !yaml_parser_copy_span(parser, &string,
+                            &span, span_end)) goto error;
                 if (!STRING_EXTEND(parser, string)) goto error;
                 *(string.pointer++) = '\'';
                 SKIP(parser);
@@ -3103,6 +3504,8 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
             {
                 size_t code_length = 0;
 
+                if (span && !yaml_parser_copy_span(parser, &string,
+                            &span, span_end)) goto error;
                 if (!STRING_EXTEND(parser, string)) goto error;
 
                 /* Check the escape character. */
@@ -3262,9 +3665,33 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
 
             else
             {
-                /* It is a non-escaped non-blank character. */
+                /*
+                 * It is a non-escaped non-blank character.  Copy it along
+                 * with the run of characters that need no checks, up to the
+                 * last non-blank one.
+                 */
+
+                size_t length = yaml_parser_scan_quoted_run(
+                        parser->buffer.pointer, parser->unread, single);
+
+                while (length > 1 && parser->buffer.pointer[length-1] == ' ')
+                    length --;
+
+                if (length > 1) {
+                    if (!span && !yaml_parser_string_append(parser, &string,
+                                parser->buffer.pointer, length)) goto error;
+                    SKIP_ASCII(parser, length);
+                }
+                else if (span) {
+                    SKIP(parser);
+                }
+                else {
+                    if (!READ(parser, string)) goto error;
+                }
 
-                if (!READ(parser, string)) goto error;
+                if (span) {
+                    span_end = INPUT_POINTER(parser);
+                }
             }
 
             if (!CACHE(parser, 2)) goto error;
@@ -3285,11 +3712,13 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
             {
                 /* Consume a space or a tab character. */
 
-                if (!leading_blanks) {
+                if (!leading_blanks && !span) {
                     if (!READ(parser, whitespaces)) goto error;
                 }
                 else {
-                    SKIP(parser);
+                    do {
+                        SKIP(parser);
+                    } while (IS_BLANK(parser->buffer));
                 }
             }
             else
@@ -3316,6 +3745,9 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
 
         if (leading_blanks)
         {
+            if (span && !yaml_parser_copy_span(parser, &string,
+                        &span, span_end)) goto error;
+
             /* Do we need to fold line breaks? */
 
             if (leading_break.start[0] == '\n') {
@@ -3336,6 +3768,12 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
                 CLEAR(parser, trailing_breaks);
             }
         }
+        else if (span)
+        {
+            /* The whitespaces are a part of the borrowed value. */
+
+            span_end = INPUT_POINTER(parser);
+        }
         else
         {
             if (!JOIN(parser, string, whitespaces)) goto error;
@@ -3347,13 +3785,21 @@ yaml_parser_scan_flow_scalar(yaml_parser_t *parser, yaml_token_t *token,
 
     SKIP(parser);
 
-    end_mark = parser->mark;
+    end_mark = MARK(parser);
 
     /* Create a token. */
 
-    SCALAR_TOKEN_INIT(*token, string.start, string.pointer-string.start,
-            single ? YAML_SINGLE_QUOTED_SCALAR_STYLE : YAML_DOUBLE_QUOTED_SCALAR_STYLE,
-            start_mark, end_mark);
+    if (span) {
+        SCALAR_TOKEN_INIT(*token, span, span_end-span,
+                single ? YAML_SINGLE_QUOTED_SCALAR_STYLE : YAML_DOUBLE_QUOTED_SCALAR_STYLE,
+                start_mark, end_mark);
+        token->data.scalar.borrowed = 1;
+    }
+    else {
+        SCALAR_TOKEN_INIT(*token, string.start, string.pointer-string.start,
+                single ? YAML_SINGLE_QUOTED_SCALAR_STYLE : YAML_DOUBLE_QUOTED_SCALAR_STYLE,
+                start_mark, end_mark);
+    }
 
     STRING_DEL(parser, leading_break);
     STRING_DEL(parser, trailing_breaks);
@@ -3370,6 +3816,122 @@ error:
     return 0;
 }
 
+/*
+ * Append a run of octets to a string.
+ */
+
+static int
+yaml_parser_string_append(yaml_parser_t *parser, yaml_string_t *string,
+        const yaml_char_t *pointer, size_t length)
+{
+    while ((size_t)(string->end - string->pointer) <= length) {
+        if (!yaml_string_extend(parser, &string->start,
+                    &string->pointer, &string->end)) {
+            parser->error = YAML_MEMORY_ERROR;
+            return 0;
+        }
+    }
+
+    memcpy(string->pointer, pointer, length);
+    string->pointer += length;
+
+    return 1;
+}
+
+/*
+ * Copy the part of a scalar value borrowed from the input so far into a new
+ * string, so that the rest can be folded or unescaped.
+ */
+
+static int
+yaml_parser_copy_span(yaml_parser_t *parser, yaml_string_t *string,
+        yaml_char_t **span, yaml_char_t *span_end)
+{
+    if (!STRING_INIT(parser, *string, INITIAL_STRING_SIZE))
+        return 0;
+
+    if (!yaml_parser_string_append(parser, string, *span, span_end - *span))
+        return 0;
+
+    *span = NULL;
+
+    return 1;
+}
+
+/*
+ * Find the run of characters that a plain scalar consumes without further
+ * checks.
+ *
+ * The functions below return the length of the longest prefix of the octets
+ * that consists of the characters [#x21-#x7E] except ':' and, in the flow
+ * context, the flow indicators.  Such a character neither ends the scalar nor
+ * needs to be joined with whitespaces, so the run can be copied at once.  The
+ * SSE2 variant checks 16 octets at once; the rest of the run is checked by the
+ * scalar loop.
+ */
+
+#define IS_PLAIN_SAFE(octet,flow)                                               \
+    ((octet) > 0x20 && (octet) < 0x7F && (octet) != ':'                         \
+     && !((flow) && ((octet) == ',' || (octet) == '?'                           \
+             || (octet) == '[' || (octet) == ']'                                \
+             || (octet) == '{' || (octet) == '}')))
+
+static size_t
+yaml_parser_scan_plain_run(const unsigned char *pointer, size_t length,
+        int flow)
+{
+    size_t k = 0;
+
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i colon = _mm_set1_epi8(':');
+
+    while (k + 16 <= length)
+    {
+        __m128i octets = _mm_loadu_si128((const __m128i *)(pointer + k));
+
+        /* Octets above 0x7F are negative and fail the signed comparison. */
+
+        __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(octets, del),
+                _mm_cmpeq_epi8(octets, colon));
+        int mask;
+
+        if (flow) {
+            stop = _mm_or_si128(stop,
+                    _mm_cmpeq_epi8(octets, _mm_set1_epi8(',')));
+            stop = _mm_or_si128(stop,
+                    _mm_cmpeq_epi8(octets, _mm_set1_epi8('?')));
+            stop = _mm_or_si128(stop,
+                    _mm_cmpeq_epi8(octets, _mm_set1_epi8('[')));
+            stop = _mm_or_si128(stop,
+                    _mm_cmpeq_epi8(octets, _mm_set1_epi8(']')));
+            stop = _mm_or_si128(stop,
+                    _mm_cmpeq_epi8(octets, _mm_set1_epi8('{')));
+            stop = _mm_or_si128(stop,
+                    _mm_cmpeq_epi8(octets, _mm_set1_epi8('}')));
+        }
+
+        mask = _mm_movemask_epi8(_mm_andnot_si128(stop,
+                    _mm_cmpgt_epi8(octets, space)));
+        if (mask != 0xFFFF) {
+            while (mask & 1) {
+                mask >>= 1;
+                k ++;
+            }
+            return k;
+        }
+
+        k += 16;
+    }
+#endif
+
+    while (k < length && IS_PLAIN_SAFE(pointer[k], flow))
+        k ++;
+
+    return k;
+}
+
 /*
  * Scan a plain scalar.
  */
@@ -3385,13 +3947,26 @@ yaml_parser_scan_plain_scalar(yaml_parser_t *parser, yaml_token_t *token)
     yaml_string_t whitespaces = NULL_STRING;
     int leading_blanks = 0;
     int indent = parser->indent+1;
+    yaml_char_t *span = NULL;
+    yaml_char_t *span_end = NULL;
+    size_t length;
 
-    if (!STRING_INIT(parser, string, INITIAL_STRING_SIZE)) goto error;
     if (!STRING_INIT(parser, leading_break, INITIAL_STRING_SIZE)) goto error;
     if (!STRING_INIT(parser, trailing_breaks, INITIAL_STRING_SIZE)) goto error;
     if (!STRING_INIT(parser, whitespaces, INITIAL_STRING_SIZE)) goto error;
 
-    start_mark = end_mark = parser->mark;
+    /*
+     * An input read in place may lend the value until it needs to be folded.
+     */
+
+    if (parser->in_place && parser->borrow_scalars) {
+        span = span_end = INPUT_POINTER(parser);
+    }
+    else {
+        if (!STRING_INIT(parser, string, INITIAL_STRING_SIZE)) goto error;
+    }
+
+    start_mark = end_mark = MARK(parser);
 
     /* Consume the content of the plain scalar. */
 
@@ -3401,7 +3976,7 @@ yaml_parser_scan_plain_scalar(yaml_parser_t *parser, yaml_token_t *token)
 
         if (!CACHE(parser, 4)) goto error;
 
-        if (parser->mark.column == 0 &&
+        if (COLUMN(parser) == 0 &&
             ((CHECK_AT(parser->buffer, '-', 0) &&
               CHECK_AT(parser->buffer, '-', 1) &&
               CHECK_AT(parser->buffer, '-', 2)) ||
@@ -3445,6 +4020,9 @@ yaml_parser_scan_plain_scalar(yaml_parser_t *parser, yaml_token_t *token)
             {
                 if (leading_blanks)
                 {
+                    if (span && !yaml_parser_copy_span(parser, &string,
+                                &span, span_end)) goto error;
+
                     /* Do we need to fold line breaks? */
 
                     if (leading_break.start[0] == '\n') {
@@ -3474,11 +4052,31 @@ yaml_parser_scan_plain_scalar(yaml_parser_t *parser, yaml_token_t *token)
                 }
             }
 
-            /* Copy the character. */
+            /*
+             * Copy the character, or the whole run of safe characters.  A
+             * borrowed value only grows over them.
+             */
 
-            if (!READ(parser, string)) goto error;
+            length = yaml_parser_scan_plain_run(parser->buffer.pointer,
+                    parser->unread, parser->flow_level);
+
+            if (length > 1) {
+                if (!span && !yaml_parser_string_append(parser, &string,
+                            parser->buffer.pointer, length)) goto error;
+                SKIP_ASCII(parser, length);
+            }
+            else if (span) {
+                SKIP(parser);
+            }
+            else {
+                if (!READ(parser, string)) goto error;
+            }
+
+            if (span) {
+                span_end = INPUT_POINTER(parser);
+            }
 
-            end_mark = parser->mark;
+            end_mark = MARK(parser);
 
             if (!CACHE(parser, 2)) goto error;
         }
@@ -3498,20 +4096,27 @@ yaml_parser_scan_plain_scalar(yaml_parser_t *parser, yaml_token_t *token)
             {
                 /* Check for tab character that abuse intendation. */
 
-                if (leading_blanks && (int)parser->mark.column < indent
+                if (leading_blanks && (int)COLUMN(parser) < indent
                         && IS_TAB(parser->buffer)) {
                     yaml_parser_set_scanner_error(parser, "while scanning a plain scalar",
                             start_mark, "found a tab character that violate intendation");
                     goto error;
                 }
 
-                /* Consume a space or a tab character. */
+                /*
+                 * Consume a space or a tab character.  A borrowed value
+                 * takes the whitespaces from the input if it goes on.  The
+                 * spaces up to the end of the buffered run are skipped at
+                 * once.
+                 */
 
-                if (!leading_blanks) {
+                if (!leading_blanks && !span) {
                     if (!READ(parser, whitespaces)) goto error;
                 }
                 else {
-                    SKIP(parser);
+                    do {
+                        SKIP(parser);
+                    } while (CHECK(parser->buffer, ' '));
                 }
             }
             else
@@ -3536,14 +4141,21 @@ yaml_parser_scan_plain_scalar(yaml_parser_t *parser, yaml_token_t *token)
 
         /* Check intendation level. */
 
-        if (!parser->flow_level && (int)parser->mark.column < indent)
+        if (!parser->flow_level && (int)COLUMN(parser) < indent)
             break;
     }
 
     /* Create a token. */
 
-    SCALAR_TOKEN_INIT(*token, string.start, string.pointer-string.start,
-            YAML_PLAIN_SCALAR_STYLE, start_mark, end_mark);
+    if (span) {
+        SCALAR_TOKEN_INIT(*token, span, span_end-span,
+                YAML_PLAIN_SCALAR_STYLE, start_mark, end_mark);
+        token->data.scalar.borrowed = 1;
+    }
+    else {
+        SCALAR_TOKEN_INIT(*token, string.start, string.pointer-string.start,
+                YAML_PLAIN_SCALAR_STYLE, start_mark, end_mark);
+    }
 
     /* Note that we change the 'simple_key_allowed' flag. */
 
@@ -3566,3 +4178,542 @@ error:
     return 0;
 }
 
+
+/*
+ * The states of the check of a pushed scalar.  Each state matches a loop of
+ * the scalar scanners above.
+ */
+
+enum {
+    PARTIAL_NONE,
+    PARTIAL_PLAIN_START,
+    PARTIAL_PLAIN_RUN,
+    PARTIAL_PLAIN_BLANKS,
+    PARTIAL_QUOTED_START,
+    PARTIAL_QUOTED_RUN,
+    PARTIAL_QUOTED_BLANKS,
+    PARTIAL_BLOCK_HEADER,
+    PARTIAL_BLOCK_BLANKS,
+    PARTIAL_BLOCK_COMMENT,
+    PARTIAL_BLOCK_BREAKS,
+    PARTIAL_BLOCK_LINE
+};
+
+/*
+ * Check that the checked input holds the given number of characters at the
+ * current position.
+ */
+
+#define PARTIAL_CACHE(input,length)                                             \
+    yaml_parser_partial_cached(&(input),(length))
+
+static int
+yaml_parser_partial_cached(const yaml_string_t *input, size_t length)
+{
+    yaml_string_t string = *input;
+
+    while (length --) {
+        if (string.pointer >= string.end) return 0;
+        MOVE(string);
+    }
+
+    return 1;
+}
+
+/*
+ * Advance the checked position over a character or a line break.
+ */
+
+#define PARTIAL_SKIP(parser,input)                                              \
+     (parser->partial.column ++,                                                \
+      MOVE(input))
+
+#define PARTIAL_SKIP_LINE(parser,input)                                         \
+     (parser->partial.column = 0,                                               \
+      IS_CRLF(input) ? ((input).pointer += 2) : MOVE(input))
+
+/*
+ * Wait until a pushed input holds the whole scalar starting at the current
+ * position.  Return 1 if the scalar scanner will not run out of the input,
+ * otherwise set the 'input_needed' flag and return 0.
+ *
+ * The scalar scanners cannot stop in the middle of a token, so a scalar cut
+ * off by the end of the input would be scanned again from its start on each
+ * feed.  Instead, the scalar is checked first by a state machine that follows
+ * the loops of the scanner without building the value.  The state is kept in
+ * the parser, so each feed continues the check where the last one stopped and
+ * the scanner itself runs once the scalar is complete.
+ */
+
+static int
+yaml_parser_check_scalar(yaml_parser_t *parser, yaml_scalar_style_t style)
+{
+    yaml_string_t input;
+    int complete;
+
+    if (!parser->push || parser->push_final)
+        return 1;
+
+    /* Decode the whole pushed input. */
+
+    if (!CACHE(parser, parser->unread+1)) {
+        if (!parser->input_needed)
+            return 0;
+        parser->input_needed = 0;
+    }
+
+    /* Start the check unless it stopped at this scalar last time. */
+
+    if (!parser->partial.state
+            || parser->partial.index != parser->mark.index) {
+        parser->partial.index = parser->mark.index;
+        parser->partial.offset = 0;
+        parser->partial.column = COLUMN(parser);
+        parser->partial.leading_blanks = 0;
+        parser->partial.increment = 0;
+        parser->partial.indent = 0;
+        parser->partial.max_indent = 0;
+        switch (style) {
+            case YAML_PLAIN_SCALAR_STYLE:
+                parser->partial.state = PARTIAL_PLAIN_START;
+                break;
+            case YAML_SINGLE_QUOTED_SCALAR_STYLE:
+            case YAML_DOUBLE_QUOTED_SCALAR_STYLE:
+                parser->partial.state = PARTIAL_QUOTED_START;
+                parser->partial.offset = 1;
+                parser->partial.column ++;
+                break;
+            default:
+                parser->partial.state = PARTIAL_BLOCK_HEADER;
+        }
+    }
+
+    input.start = parser->buffer.pointer;
+    input.end = parser->buffer.last;
+    input.pointer = input.start + parser->partial.offset;
+
+    switch (style) {
+        case YAML_PLAIN_SCALAR_STYLE:
+            complete = yaml_parser_check_plain_scalar(parser, &input);
+            break;
+        case YAML_SINGLE_QUOTED_SCALAR_STYLE:
+        case YAML_DOUBLE_QUOTED_SCALAR_STYLE:
+            complete = yaml_parser_check_quoted_scalar(parser, &input,
+                    style == YAML_SINGLE_QUOTED_SCALAR_STYLE);
+            break;
+        default:
+            complete = yaml_parser_check_block_scalar(parser, &input);
+    }
+
+    if (complete) {
+        parser->partial.state = PARTIAL_NONE;
+        return 1;
+    }
+
+    parser->partial.offset = input.pointer - input.start;
+    parser->input_needed = 1;
+
+    return 0;
+}
+
+/*
+ * Check a pushed plain scalar.  See yaml_parser_scan_plain_scalar().
+ */
+
+static int
+yaml_parser_check_plain_scalar(yaml_parser_t *parser, yaml_string_t *input)
+{
+    int indent = parser->indent+1;
+    size_t length;
+
+    while (1)
+    {
+        switch (parser->partial.state)
+        {
+            case PARTIAL_PLAIN_START:
+
+                /* Check for a document indicator or a comment. */
+
+                if (!PARTIAL_CACHE(*input, 4)) return 0;
+
+                if (parser->partial.column == 0 &&
+                    ((CHECK_AT(*input, '-', 0) &&
+                      CHECK_AT(*input, '-', 1) &&
+                      CHECK_AT(*input, '-', 2)) ||
+                     (CHECK_AT(*input, '.', 0) &&
+                      CHECK_AT(*input, '.', 1) &&
+                      CHECK_AT(*input, '.', 2))) &&
+                    IS_BLANKZ_AT(*input, 3)) return 1;
+
+                if (CHECK(*input, '#')) return 1;
+
+                parser->partial.state = PARTIAL_PLAIN_RUN;
+                break;
+
+            case PARTIAL_PLAIN_RUN:
+
+                /* Check the non-blank characters. */
+
+                if (!PARTIAL_CACHE(*input, 2)) return 0;
+
+                if (IS_BLANKZ(*input)) {
+                    if (!(IS_BLANK(*input) || IS_BREAK(*input))) return 1;
+                    parser->partial.state = PARTIAL_PLAIN_BLANKS;
+                    break;
+                }
+
+                if ((CHECK(*input, ':')
+                            && (parser->flow_level || IS_BLANKZ_AT(*input, 1)))
+                        || (parser->flow_level &&
+                            (CHECK(*input, ',') || CHECK(*input, '?')
+                             || CHECK(*input, '[') || CHECK(*input, ']')
+                             || CHECK(*input, '{') || CHECK(*input, '}'))))
+                    return 1;
+
+                parser->partial.leading_blanks = 0;
+
+                length = yaml_parser_scan_plain_run(input->pointer,
+                        input->end - input->pointer, parser->flow_level);
+
+                if (length > 1) {
+                    input->pointer += length;
+                    parser->partial.column += length;
+                }
+                else {
+                    PARTIAL_SKIP(parser, *input);
+                }
+                break;
+
+            case PARTIAL_PLAIN_BLANKS:
+
+                /* Check the blank characters and the intendation. */
+
+                if (!PARTIAL_CACHE(*input, 1)) return 0;
+
+                if (IS_BLANK(*input)) {
+                    if (parser->partial.leading_blanks
+                            && (int)parser->partial.column < indent
+                            && IS_TAB(*input)) return 1;
+                    PARTIAL_SKIP(parser, *input);
+                }
+                else if (IS_BREAK(*input)) {
+                    if (!PARTIAL_CACHE(*input, 2)) return 0;
+                    PARTIAL_SKIP_LINE(parser, *input);
+                    parser->partial.leading_blanks = 1;
+                }
+                else {
+                    if (!parser->flow_level
+                            && (int)parser->partial.column < indent) return 1;
+                    parser->partial.state = PARTIAL_PLAIN_START;
+                }
+                break;
+
+            default:
+                assert(0);      /* Impossible. */
+                return 1;
+        }
+    }
+}
+
+/*
+ * Check a pushed quoted scalar.  See yaml_parser_scan_flow_scalar().
+ */
+
+static int
+yaml_parser_check_quoted_scalar(yaml_parser_t *parser, yaml_string_t *input,
+        int single)
+{
+    size_t length;
+
+    while (1)
+    {
+        switch (parser->partial.state)
+        {
+            case PARTIAL_QUOTED_START:
+
+                /* Check for a document indicator or the end of the stream. */
+
+                if (!PARTIAL_CACHE(*input, 4)) return 0;
+
+                if (parser->partial.column == 0 &&
+                    ((CHECK_AT(*input, '-', 0) &&
+                      CHECK_AT(*input, '-', 1) &&
+                      CHECK_AT(*input, '-', 2)) ||
+                     (CHECK_AT(*input, '.', 0) &&
+                      CHECK_AT(*input, '.', 1) &&
+                      CHECK_AT(*input, '.', 2))) &&
+                    IS_BLANKZ_AT(*input, 3)) return 1;
+
+                if (IS_Z(*input)) return 1;
+
+                parser->partial.state = PARTIAL_QUOTED_RUN;
+                break;
+
+            case PARTIAL_QUOTED_RUN:
+
+                /* Check the non-blank characters. */
+
+                if (!PARTIAL_CACHE(*input, 2)) return 0;
+
+                if (IS_BLANKZ(*input)) {
+                    parser->partial.state = PARTIAL_QUOTED_BLANKS;
+                }
+                else if (single && CHECK_AT(*input, '\'', 0)
+                        && CHECK_AT(*input, '\'', 1)) {
+                    input->pointer += 2;
+                    parser->partial.column += 2;
+                }
+                else if (CHECK(*input, single ? '\'' : '"')) {
+                    return 1;
+                }
+                else if (!single && CHECK(*input, '\\')
+                        && IS_BREAK_AT(*input, 1)) {
+                    if (!PARTIAL_CACHE(*input, 3)) return 0;
+                    input->pointer ++;
+                    PARTIAL_SKIP_LINE(parser, *input);
+                    parser->partial.state = PARTIAL_QUOTED_BLANKS;
+                }
+                else if (!single && CHECK(*input, '\\')) {
+                    size_t code_length = 0;
+
+                    switch (input->pointer[1]) {
+                        case '0': case 'a': case 'b': case 't': case '\t':
+                        case 'n': case 'v': case 'f': case 'r': case 'e':
+                        case ' ': case '"': case '\'': case '\\': case 'N':
+                        case '_': case 'L': case 'P':
+                            break;
+                        case 'x':
+                            code_length = 2;
+                            break;
+                        case 'u':
+                            code_length = 4;
+                            break;
+                        case 'U':
+                            code_length = 8;
+                            break;
+                        default:
+                            return 1;
+                    }
+
+                    if (code_length) {
+                        unsigned int value = 0;
+                        size_t k;
+
+                        if (!PARTIAL_CACHE(*input, 2+code_length)) return 0;
+
+                        for (k = 2; k < 2+code_length; k ++) {
+                            if (!IS_HEX_AT(*input, k)) return 1;
+                            value = (value << 4) + AS_HEX_AT(*input, k);
+                        }
+                        if ((value >= 0xD800 && value <= 0xDFFF)
+                                || value > 0x10FFFF) return 1;
+                    }
+
+                    input->pointer += 2+code_length;
+                    parser->partial.column += 2+code_length;
+                }
+                else {
+                    length = yaml_parser_scan_quoted_run(input->pointer,
+                            input->end - input->pointer, single);
+
+                    while (length > 1 && input->pointer[length-1] == ' ')
+                        length --;
+
+                    if (length > 1) {
+                        input->pointer += length;
+                        parser->partial.column += length;
+                    }
+                    else {
+                        PARTIAL_SKIP(parser, *input);
+                    }
+                }
+                break;
+
+            case PARTIAL_QUOTED_BLANKS:
+
+                /* Check the blank characters. */
+
+                if (!PARTIAL_CACHE(*input, 1)) return 0;
+
+                if (IS_BLANK(*input)) {
+                    PARTIAL_SKIP(parser, *input);
+                }
+                else if (IS_BREAK(*input)) {
+                    if (!PARTIAL_CACHE(*input, 2)) return 0;
+                    PARTIAL_SKIP_LINE(parser, *input);
+                }
+                else {
+                    parser->partial.state = PARTIAL_QUOTED_START;
+                }
+                break;
+
+            default:
+                assert(0);      /* Impossible. */
+                return 1;
+        }
+    }
+}
+
+/*
+ * Check a pushed block scalar.  See yaml_parser_scan_block_scalar() and
+ * yaml_parser_scan_block_scalar_breaks().
+ */
+
+static int
+yaml_parser_check_block_scalar(yaml_parser_t *parser, yaml_string_t *input)
+{
+    size_t length;
+
+    while (1)
+    {
+        switch (parser->partial.state)
+        {
+            case PARTIAL_BLOCK_HEADER:
+
+                /*
+                 * Check the indicators.  They are short, so the check starts
+                 * over if they are cut off.
+                 */
+
+                input->pointer = input->start + 1;
+                parser->partial.increment = 0;
+
+                if (!PARTIAL_CACHE(*input, 1)) goto header_cut;
+
+                if (CHECK(*input, '+') || CHECK(*input, '-')) {
+                    input->pointer ++;
+                    if (!PARTIAL_CACHE(*input, 1)) goto header_cut;
+                    if (IS_DIGIT(*input)) {
+                        if (CHECK(*input, '0')) return 1;
+                        parser->partial.increment = AS_DIGIT(*input);
+                        input->pointer ++;
+                    }
+                }
+                else if (IS_DIGIT(*input)) {
+                    if (CHECK(*input, '0')) return 1;
+                    parser->partial.increment = AS_DIGIT(*input);
+                    input->pointer ++;
+                    if (!PARTIAL_CACHE(*input, 1)) goto header_cut;
+                    if (CHECK(*input, '+') || CHECK(*input, '-'))
+                        input->pointer ++;
+                }
+
+                parser->partial.state = PARTIAL_BLOCK_BLANKS;
+                break;
+
+            header_cut:
+                input->pointer = input->start;
+                return 0;
+
+            case PARTIAL_BLOCK_BLANKS:
+            case PARTIAL_BLOCK_COMMENT:
+
+                /* Check the whitespaces and the comment after the indicators. */
+
+                if (!PARTIAL_CACHE(*input, 1)) return 0;
+
+                if (parser->partial.state == PARTIAL_BLOCK_BLANKS
+                        && IS_BLANK(*input)) {
+                    input->pointer ++;
+                    break;
+                }
+                if (parser->partial.state == PARTIAL_BLOCK_BLANKS
+                        && CHECK(*input, '#')) {
+                    parser->partial.state = PARTIAL_BLOCK_COMMENT;
+                }
+                if (parser->partial.state == PARTIAL_BLOCK_COMMENT
+                        && !IS_BREAKZ(*input)) {
+                    MOVE(*input);
+                    break;
+                }
+
+                if (!IS_BREAK(*input)) return 1;
+                if (!PARTIAL_CACHE(*input, 2)) return 0;
+                PARTIAL_SKIP_LINE(parser, *input);
+
+                if (parser->partial.increment) {
+                    parser->partial.indent = parser->indent >= 0
+                        ? parser->indent+parser->partial.increment
+                        : parser->partial.increment;
+                }
+                parser->partial.max_indent = 0;
+                parser->partial.state = PARTIAL_BLOCK_BREAKS;
+                break;
+
+            case PARTIAL_BLOCK_BREAKS:
+
+                /* Check the intendation spaces and the empty lines. */
+
+                if (!PARTIAL_CACHE(*input, 1)) return 0;
+
+                if ((!parser->partial.indent
+                            || (int)parser->partial.column < parser->partial.indent)
+                        && IS_SPACE(*input)) {
+                    PARTIAL_SKIP(parser, *input);
+                    break;
+                }
+
+                if ((int)parser->partial.column > parser->partial.max_indent)
+                    parser->partial.max_indent = (int)parser->partial.column;
+
+                if ((!parser->partial.indent
+                            || (int)parser->partial.column < parser->partial.indent)
+                        && IS_TAB(*input)) return 1;
+
+                if (IS_BREAK(*input)) {
+                    if (!PARTIAL_CACHE(*input, 2)) return 0;
+                    PARTIAL_SKIP_LINE(parser, *input);
+                    break;
+                }
+
+                /* Determine the indentation level if needed. */
+
+                if (!parser->partial.indent) {
+                    parser->partial.indent = parser->partial.max_indent;
+                    if (parser->partial.indent < parser->indent + 1)
+                        parser->partial.indent = parser->indent + 1;
+                    if (parser->partial.indent < 1)
+                        parser->partial.indent = 1;
+                }
+
+                /* Is it the end of the scalar? */
+
+                if ((int)parser->partial.column != parser->partial.indent
+                        || IS_Z(*input)) return 1;
+
+                parser->partial.state = PARTIAL_BLOCK_LINE;
+                break;
+
+            case PARTIAL_BLOCK_LINE:
+
+                /* Check the line content and the line break. */
+
+                if (!PARTIAL_CACHE(*input, 1)) return 0;
+
+                if (!IS_BREAKZ(*input)) {
+                    length = yaml_parser_scan_line_run(input->pointer,
+                            input->end - input->pointer);
+                    if (length > 1) {
+                        input->pointer += length;
+                    }
+                    else {
+                        MOVE(*input);
+                    }
+                    break;
+                }
+
+                if (!PARTIAL_CACHE(*input, 2)) return 0;
+                if (!IS_BREAK(*input)) return 1;
+                PARTIAL_SKIP_LINE(parser, *input);
+
+                parser->partial.max_indent = 0;
+                parser->partial.state = PARTIAL_BLOCK_BREAKS;
+                break;
+
+            default:
+                assert(0);      /* Impossible. */
+                return 1;
+        }
+    }
+}
+
@@ -0,0 +1,211 @@
+/*
+ * Check the table of anchors that yaml_parser_load() resolves aliases with,
+ * and time it for a doubling number of anchors.
+ *
+ * The test is not a part of the Perl build; run it from the LibYAML
+ * directory:
+ *
+ *      cc -O2 -I. -DHAVE_CONFIG_H tests/test-aliases.c api.c reader.c \
+ *          scanner.c parser.c loader.c writer.c emitter.c dumper.c \
+ *          -o test-aliases && ./test-aliases
+ *
+ * The table is a hash table that doubles when it is half full, so loading
+ * twice as many anchors and aliases should take about twice as long.  The
+ * check fails if 16 times as many take more than 64 times as long.
+ */
+
+#include <yaml.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <assert.h>
+
+/*
+ * Build a sequence of the given number of anchored scalars followed by an
+ * alias to each of them, in reverse order.
+ */
+
+static char *
+anchors_and_aliases(int count)
+{
+    char *input = malloc((size_t)count*48 + 16);
+    char *pointer = input;
+    int k;
+
+    assert(input);
+    pointer += sprintf(pointer, "---\n");
+    for (k = 0; k < count; k ++)
+        pointer += sprintf(pointer, "- &anchor%d value%d\n", k, k);
+    for (k = count-1; k >= 0; k --)
+        pointer += sprintf(pointer, "- *anchor%d\n", k);
+
+    return input;
+}
+
+static int
+load(yaml_parser_t *parser, const char *input, yaml_document_t *document)
+{
+    assert(yaml_parser_initialize(parser));
+    yaml_parser_set_input_string(parser,
+            (const unsigned char *)input, strlen(input));
+
+    return yaml_parser_load(parser, document);
+}
+
+/*
+ * Every alias resolves to the node of its anchor, across many growths of
+ * the table.
+ */
+
+static void
+check_growth(int count)
+{
+    yaml_parser_t parser;
+    yaml_document_t document;
+    yaml_node_t *root;
+    char *input = anchors_and_aliases(count);
+    int k;
+
+    assert(load(&parser, input, &document));
+    root = yaml_document_get_root_node(&document);
+    assert(root && root->type == YAML_SEQUENCE_NODE);
+    assert(root->data.sequence.items.top - root->data.sequence.items.start
+            == 2*count);
+
+    for (k = 0; k < count; k ++) {
+        yaml_node_item_t anchored = root->data.sequence.items.start[k];
+        yaml_node_item_t alias = root->data.sequence.items.start[2*count-1-k];
+        yaml_node_t *node = yaml_document_get_node(&document, anchored);
+        char value[32];
+
+        sprintf(value, "value%d", k);
+        assert(alias == anchored);
+        assert(node->type == YAML_SCALAR_NODE);
+        assert(strcmp((char *)node->data.scalar.value, value) == 0);
+    }
+
+    yaml_document_delete(&document);
+    yaml_parser_delete(&parser);
+    free(input);
+}
+
+/*
+ * A second anchor of the same name is an error that points at both.
+ */
+
+static void
+check_duplicate(void)
+{
+    yaml_parser_t parser;
+    yaml_document_t document;
+
+    assert(!load(&parser, "- &a 1\n- &b 2\n- &a 3\n", &document));
+    assert(parser.error == YAML_COMPOSER_ERROR);
+    assert(strcmp(parser.problem, "second occurence") == 0);
+    assert(parser.context_mark.line == 0 && parser.problem_mark.line == 2);
+
+    yaml_parser_delete(&parser);
+}
+
+/*
+ * An alias to an anchor that is not defined yet is an error.
+ */
+
+static void
+check_undefined(void)
+{
+    yaml_parser_t parser;
+    yaml_document_t document;
+
+    assert(!load(&parser, "- *a\n- &a 1\n", &document));
+    assert(parser.error == YAML_COMPOSER_ERROR);
+    assert(strcmp(parser.problem, "found undefined alias") == 0);
+
+    yaml_parser_delete(&parser);
+}
+
+/*
+ * Each document starts with an empty table: its anchors may reuse the names
+ * of the previous document, and its aliases cannot refer to them.
+ */
+
+static void
+check_reset(void)
+{
+    yaml_parser_t parser;
+    yaml_document_t document;
+
+    assert(load(&parser, "--- [&a 1, *a]\n--- [&a 2, *a]\n--- *a\n",
+                &document));
+    yaml_document_delete(&document);
+
+    assert(yaml_parser_load(&parser, &document));
+    assert(yaml_document_get_root_node(&document));
+    yaml_document_delete(&document);
+
+    assert(!yaml_parser_load(&parser, &document));
+    assert(strcmp(parser.problem, "found undefined alias") == 0);
+
+    yaml_parser_delete(&parser);
+}
+
+static double
+load_time(int count)
+{
+    yaml_parser_t parser;
+    yaml_document_t document;
+    char *input = anchors_and_aliases(count);
+    double best = 0;
+    int round;
+
+    for (round = 0; round < 3; round ++) {
+        clock_t start = clock();
+        double took;
+
+        assert(load(&parser, input, &document));
+        took = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (!round || took < best)
+            best = took;
+
+        yaml_document_delete(&document);
+        yaml_parser_delete(&parser);
+    }
+
+    free(input);
+
+    return best;
+}
+
+int
+main(void)
+{
+    double first = 0, took = 0;
+    int count;
+
+    check_growth(1);
+    check_growth(1000);
+    check_duplicate();
+    check_undefined();
+    check_reset();
+
+    for (count = 1 << 14; count <= 1 << 18; count <<= 1) {
+        took = load_time(count);
+        if (count == 1 << 14)
+            first = took;
+        printf("%7d anchors: %.4fs\n", count, took);
+    }
+
+    if (took > 64*first + 0.01) {
+        printf("16 times as many anchors took %.1f times as long\n",
+                took/first);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,316 @@
+/*
+ * Check that the objects of libyaml use the allocators they are given.
+ *
+ * Each allocator below counts its blocks and marks them with its owner, so a
+ * block freed or reallocated by the wrong allocator aborts the check.  The
+ * test is not a part of the Perl build; run it from the LibYAML directory:
+ *
+ *      cc -I. -DHAVE_CONFIG_H tests/test-allocator.c api.c reader.c \
+ *          scanner.c parser.c loader.c writer.c emitter.c dumper.c \
+ *          -o test-allocator && ./test-allocator
+ */
+
+#include <yaml.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <assert.h>
+
+typedef struct {
+    const char *name;
+    long mallocs;
+    long live;
+} counter_t;
+
+typedef struct {
+    counter_t *owner;
+    double align;
+} header_t;
+
+static void *
+counted_malloc(void *data, size_t size)
+{
+    header_t *header = malloc(sizeof(header_t) + size);
+
+    if (!header) return NULL;
+    header->owner = data;
+    header->owner->mallocs ++;
+    header->owner->live ++;
+
+    return header + 1;
+}
+
+static void *
+counted_realloc(void *data, void *ptr, size_t size)
+{
+    header_t *header = (header_t *)ptr - 1;
+
+    if (header->owner != data) {
+        fprintf(stderr, "a %s block is reallocated by the %s allocator\n",
+                header->owner->name, ((counter_t *)data)->name);
+        abort();
+    }
+
+    header = realloc(header, sizeof(header_t) + size);
+
+    return header ? header + 1 : NULL;
+}
+
+static void
+counted_free(void *data, void *ptr)
+{
+    header_t *header = (header_t *)ptr - 1;
+
+    if (header->owner != data) {
+        fprintf(stderr, "a %s block is freed by the %s allocator\n",
+                header->owner->name, ((counter_t *)data)->name);
+        abort();
+    }
+
+    header->owner->live --;
+    free(header);
+}
+
+static counter_t global = { "global", 0, 0 };
+static counter_t own = { "parser", 0, 0 };
+static counter_t emitter_own = { "emitter", 0, 0 };
+
+static yaml_allocator_t global_allocator =
+    { counted_malloc, counted_realloc, counted_free, &global };
+static yaml_allocator_t parser_allocator =
+    { counted_malloc, counted_realloc, counted_free, &own };
+static yaml_allocator_t emitter_allocator =
+    { counted_malloc, counted_realloc, counted_free, &emitter_own };
+
+static const char *input =
+    "%TAG !e! tag:example.com,2000:\n"
+    "--- !e!root\n"
+    "a: &x [1, 2, !e!foo \"q\\tq\"]\n"
+    "b: *x\n"
+    "c: |\n  literal\n  text\n"
+    "d: {k: v, ? long : !!str 3}\n"
+    "--- plain\n"
+    "...\n"
+    "%YAML 1.1\n"
+    "--- [x, y]\n";
+
+enum { STRING_INPUT, IN_PLACE_INPUT, PUSHED_INPUT };
+
+static int
+write_handler(void *data, unsigned char *buffer, size_t size)
+{
+    return 1;
+}
+
+/*
+ * Check that no block is left and, if the parser has its own allocator, that
+ * the global one was not used.
+ */
+
+static void
+check(const char *what, int owned)
+{
+    printf("%-40s global %ld, parser %ld, emitter %ld\n", what,
+            global.mallocs, own.mallocs, emitter_own.mallocs);
+
+    assert(!global.live && !own.live && !emitter_own.live);
+    if (owned)
+        assert(!global.mallocs);
+
+    global.mallocs = own.mallocs = emitter_own.mallocs = 0;
+}
+
+static void
+setup(yaml_parser_t *parser, int mode, int arena, int owned)
+{
+    assert(yaml_parser_initialize(parser));
+    if (arena)
+        yaml_parser_set_arena(parser, 1);
+    if (arena > 1)
+        yaml_parser_set_share_tags(parser, 1);
+    if (owned)
+        yaml_parser_set_allocator(parser, &parser_allocator);
+    if (mode == STRING_INPUT)
+        yaml_parser_set_input_string(parser,
+                (const unsigned char *)input, strlen(input));
+    if (mode == IN_PLACE_INPUT)
+        yaml_parser_set_input_string_in_place(parser,
+                (const unsigned char *)input, strlen(input));
+}
+
+/*
+ * Parse the events of the input, pushing it in chunks of 7 octets.
+ */
+
+static void
+parse(int mode, int arena, int owned)
+{
+    yaml_parser_t parser;
+    yaml_event_t event;
+    size_t fed = 0;
+    int done = 0;
+
+    setup(&parser, mode, arena, owned);
+
+    while (!done) {
+        if (mode == PUSHED_INPUT && parser.input_needed) {
+            size_t size = strlen(input) - fed < 7 ? strlen(input) - fed : 7;
+            assert(yaml_parser_feed(&parser,
+                        (const unsigned char *)input + fed, size,
+                        fed + size == strlen(input)));
+            fed += size;
+        }
+        assert(yaml_parser_parse(&parser, &event));
+        done = (event.type == YAML_STREAM_END_EVENT);
+        yaml_event_delete(&event);
+    }
+
+    yaml_parser_delete(&parser);
+}
+
+/*
+ * Push a scalar larger than the input buffers in a single chunk, so that the
+ * buffers grow.
+ */
+
+static void
+push_large(int owned)
+{
+    yaml_parser_t parser;
+    yaml_event_t event;
+    size_t size = 200*1024;
+    unsigned char *large = malloc(size);
+    int done = 0;
+
+    assert(large);
+    memcpy(large, "--- ", 4);
+    memset(large+4, 'x', size-5);
+    large[size-1] = '\n';
+
+    setup(&parser, PUSHED_INPUT, 0, owned);
+    assert(yaml_parser_feed(&parser, large, size, 1));
+    free(large);
+
+    while (!done) {
+        assert(yaml_parser_parse(&parser, &event));
+        if (event.type == YAML_SCALAR_EVENT)
+            assert(event.data.scalar.length == size-5);
+        done = (event.type == YAML_STREAM_END_EVENT);
+        yaml_event_delete(&event);
+    }
+
+    yaml_parser_delete(&parser);
+}
+
+static void
+scan(int arena, int owned)
+{
+    yaml_parser_t parser;
+    yaml_token_t token;
+    int done = 0;
+
+    setup(&parser, STRING_INPUT, arena, owned);
+
+    while (!done) {
+        assert(yaml_parser_scan(&parser, &token));
+        done = (token.type == YAML_STREAM_END_TOKEN);
+        yaml_token_delete(&token);
+    }
+
+    yaml_parser_delete(&parser);
+}
+
+/*
+ * Load the documents, reset the parser and load them again, then dump them
+ * after the parser is gone.
+ */
+
+static void
+load_dump(int arena, int owned, int emitter_owned)
+{
+    yaml_parser_t parser;
+    yaml_emitter_t emitter;
+    yaml_document_t documents[8];
+    int count, round, k;
+
+    setup(&parser, STRING_INPUT, arena, owned);
+
+    for (round = 0; round < 2; round ++) {
+        if (round) {
+            for (k = 0; k < count; k ++)
+                yaml_document_delete(documents+k);
+            yaml_parser_reset(&parser);
+            if (arena)
+                yaml_parser_set_arena(&parser, 1);
+            yaml_parser_set_input_string(&parser,
+                    (const unsigned char *)input, strlen(input));
+        }
+        for (count = 0; ; count ++) {
+            assert(yaml_parser_load(&parser, documents+count));
+            if (!yaml_document_get_root_node(documents+count)) {
+                yaml_document_delete(documents+count);
+                break;
+            }
+        }
+    }
+
+    yaml_parser_delete(&parser);
+
+    assert(yaml_emitter_initialize(&emitter));
+    if (emitter_owned)
+        assert(yaml_emitter_set_allocator(&emitter, &emitter_allocator));
+    yaml_emitter_set_output(&emitter, write_handler, NULL);
+    assert(yaml_emitter_open(&emitter));
+
+    /* A loaded document may still grow. */
+
+    assert(yaml_document_add_scalar(documents, NULL,
+                (yaml_char_t *)"extra", -1, YAML_ANY_SCALAR_STYLE) > 0);
+
+    for (k = 0; k < count; k ++)
+        assert(yaml_emitter_dump(&emitter, documents+k));
+
+    assert(yaml_emitter_close(&emitter));
+    yaml_emitter_delete(&emitter);
+}
+
+int
+main(void)
+{
+    char what[64];
+    int owned, arena, mode, emitter_owned;
+
+    yaml_set_allocator(&global_allocator);
+
+    for (owned = 0; owned <= 1; owned ++) {
+        for (arena = 0; arena <= 2; arena ++) {
+            for (mode = STRING_INPUT; mode <= PUSHED_INPUT; mode ++) {
+                parse(mode, arena, owned);
+                sprintf(what, "parse: input %d, arena %d, own %d",
+                        mode, arena, owned);
+                check(what, owned);
+            }
+            scan(arena, owned);
+            sprintf(what, "scan: arena %d, own %d", arena, owned);
+            check(what, owned);
+            for (emitter_owned = 0; emitter_owned <= 1; emitter_owned ++) {
+                load_dump(arena, owned, emitter_owned);
+                sprintf(what, "load and dump: arena %d, own %d, emitter %d",
+                        arena, owned, emitter_owned);
+                check(what, 0);
+            }
+        }
+        push_large(owned);
+        sprintf(what, "push a large chunk: own %d", owned);
+        check(what, owned);
+    }
+
+    yaml_set_allocator(NULL);
+
+    return 0;
+}
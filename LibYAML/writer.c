@@ -34,9 +34,37 @@ yaml_emitter_flush(yaml_emitter_t *emitter)
     int low, high;
 
     assert(emitter);    /* Non-NULL emitter object is expected. */
-    assert(emitter->write_handler); /* Write handler must be set. */
+    assert(emitter->write_handler || emitter->output_buffer_handler);
+                                /* Output must be set. */
     assert(emitter->encoding);  /* Output encoding must be set. */
 
+    /*
+     * The output buffer is already the output; let the handler note the
+     * length and grow the buffer if it is full.
+     */
+
+    if (emitter->output_buffer_handler)
+    {
+        size_t length = emitter->buffer.pointer - emitter->buffer.start;
+        size_t size = emitter->buffer.end - emitter->buffer.start;
+
+        if (emitter->buffer.pointer+5 >= emitter->buffer.end) {
+            size *= 2;
+        }
+
+        if (!emitter->output_buffer_handler(emitter->write_handler_data,
+                    length, &emitter->buffer.start, &size)) {
+            return yaml_emitter_set_writer_error(emitter,
+                    "Output buffer error");
+        }
+
+        emitter->buffer.end = emitter->buffer.start + size;
+        emitter->buffer.pointer = emitter->buffer.start + length;
+        emitter->buffer.last = emitter->buffer.pointer;
+
+        return 1;
+    }
+
     emitter->buffer.last = emitter->buffer.pointer;
     emitter->buffer.pointer = emitter->buffer.start;
 
@@ -69,6 +69,74 @@ yaml_get_version(int *major, int *minor, int *patch);
 
 /** @} */
 
+/**
+ * @defgroup memory Memory Management
+ * @{
+ */
+
+/**
+ * The prototype of an allocation function.
+ *
+ * @param[in]   data    The application data of the allocator.
+ * @param[in]   size    The size of the block, never @c 0.
+ *
+ * @returns A pointer to the new block, or @c NULL on error.
+ */
+
+typedef void *yaml_malloc_handler_t(void *data, size_t size);
+
+/**
+ * The prototype of a reallocation function.
+ *
+ * @param[in]   data    The application data of the allocator.
+ * @param[in]   ptr     A block of the allocator, never @c NULL.
+ * @param[in]   size    The new size of the block, never @c 0.
+ *
+ * @returns A pointer to the resized block, or @c NULL on error.
+ */
+
+typedef void *yaml_realloc_handler_t(void *data, void *ptr, size_t size);
+
+/**
+ * The prototype of a deallocation function.
+ *
+ * @param[in]   data    The application data of the allocator.
+ * @param[in]   ptr     A block of the allocator, never @c NULL.
+ */
+
+typedef void yaml_free_handler_t(void *data, void *ptr);
+
+/** The functions that allocate memory. */
+typedef struct yaml_allocator_s {
+    /** The allocation function. */
+    yaml_malloc_handler_t *malloc_handler;
+    /** The reallocation function. */
+    yaml_realloc_handler_t *realloc_handler;
+    /** The deallocation function. */
+    yaml_free_handler_t *free_handler;
+    /** The application data for passing to the functions. */
+    void *data;
+} yaml_allocator_t;
+
+/**
+ * Set the global allocator.
+ *
+ * The library allocates memory with the global allocator unless a parser or
+ * an emitter has an allocator of its own (see yaml_parser_set_allocator() and
+ * yaml_emitter_set_allocator()).  The allocator is copied.  A block must be
+ * freed by the allocator that allocated it, so the global allocator must not
+ * change while any object of the library is alive, and it is not safe to set
+ * while other threads use the library.
+ *
+ * @param[in]   allocator   An allocator, or @c NULL for the allocator of the
+ *                          C library.
+ */
+
+YAML_DECLARE(void)
+yaml_set_allocator(const yaml_allocator_t *allocator);
+
+/** @} */
+
 /**
  * @defgroup basic Basic Types
  * @{
@@ -306,6 +374,11 @@ typedef struct yaml_token_s {
             size_t length;
             /** The scalar style. */
             yaml_scalar_style_t style;
+            /**
+             * Does the value point into the input?  Such a value is not
+             * owned by the token and is not NUL-terminated.
+             */
+            int borrowed;
         } scalar;
 
         /** The version directive (for @c YAML_VERSION_DIRECTIVE_TOKEN). */
@@ -331,6 +404,18 @@ typedef struct yaml_token_s {
     /** The end of the token. */
     yaml_mark_t end_mark;
 
+    /**
+     * Are the strings of the token allocated in the arena of the parser?  Such
+     * strings are not owned by the token (see yaml_parser_set_arena()).
+     */
+    int arena;
+
+    /**
+     * The allocator of the strings of the token, or @c NULL for the global
+     * allocator (see yaml_parser_set_allocator()).
+     */
+    const yaml_allocator_t *allocator;
+
 } yaml_token_t;
 
 /**
@@ -440,6 +525,16 @@ typedef struct yaml_event_s {
             int quoted_implicit;
             /** The scalar style. */
             yaml_scalar_style_t style;
+            /**
+             * Does the value point into the input?  Such a value is not
+             * owned by the event and is not NUL-terminated.
+             */
+            int borrowed;
+            /**
+             * Is the tag shared with other events?  Such a tag is owned by
+             * the parser (see yaml_parser_set_share_tags()).
+             */
+            int tag_shared;
         } scalar;
 
         /** The sequence parameters (for @c YAML_SEQUENCE_START_EVENT). */
@@ -452,6 +547,11 @@ typedef struct yaml_event_s {
             int implicit;
             /** The sequence style. */
             yaml_sequence_style_t style;
+            /**
+             * Is the tag shared with other events?  Such a tag is owned by
+             * the parser (see yaml_parser_set_share_tags()).
+             */
+            int tag_shared;
         } sequence_start;
 
         /** The mapping parameters (for @c YAML_MAPPING_START_EVENT). */
@@ -464,6 +564,11 @@ typedef struct yaml_event_s {
             int implicit;
             /** The mapping style. */
             yaml_mapping_style_t style;
+            /**
+             * Is the tag shared with other events?  Such a tag is owned by
+             * the parser (see yaml_parser_set_share_tags()).
+             */
+            int tag_shared;
         } mapping_start;
 
     } data;
@@ -473,6 +578,18 @@ typedef struct yaml_event_s {
     /** The end of the event. */
     yaml_mark_t end_mark;
 
+    /**
+     * Are the strings of the event allocated in the arena of the parser?  Such
+     * strings are not owned by the event (see yaml_parser_set_arena()).
+     */
+    int arena;
+
+    /**
+     * The allocator of the strings of the event, or @c NULL for the global
+     * allocator (see yaml_parser_set_allocator()).
+     */
+    const yaml_allocator_t *allocator;
+
 } yaml_event_t;
 
 /**
@@ -808,6 +925,12 @@ typedef struct yaml_document_s {
     /** The end of the document. */
     yaml_mark_t end_mark;
 
+    /**
+     * The allocator of the nodes and strings of the document, or @c NULL for
+     * the global allocator (see yaml_parser_set_allocator()).
+     */
+    const yaml_allocator_t *allocator;
+
 } yaml_document_t;
 
 /**
@@ -1058,6 +1181,19 @@ typedef enum yaml_parser_state_e {
     YAML_PARSE_END_STATE
 } yaml_parser_state_t;
 
+/**
+ * This structure holds a tag directive or a tag resolved with one.
+ */
+
+typedef struct yaml_tag_data_s {
+    /** The tag handle. */
+    yaml_char_t *handle;
+    /** The tag suffix, or @c NULL for a tag directive. */
+    yaml_char_t *suffix;
+    /** The resolved tag, or the prefix of a tag directive. */
+    yaml_char_t *tag;
+} yaml_tag_data_t;
+
 /**
  * This structure holds aliases data.
  */
@@ -1131,9 +1267,47 @@ typedef struct yaml_parser_s {
         FILE *file;
     } input;
 
+    /** The memory-mapped input file. */
+    struct {
+        /** The beginning of the mapping. */
+        void *start;
+        /** The size of the mapping. */
+        size_t size;
+    } mapping;
+
     /** EOF flag */
     int eof;
 
+    /** Does the working buffer point into the input string? */
+    int in_place;
+
+    /** May scalar values point into an input string read in place? */
+    int borrow_scalars;
+
+    /** May events share the tags resolved in a document? */
+    int share_tags;
+
+    /** Are the strings of a document allocated in the arena? */
+    int use_arena;
+
+    /** The allocator of the parser, or @c NULL for the global allocator. */
+    const yaml_allocator_t *allocator;
+
+    /** The size of a string input, or 0 if the size is not known. */
+    size_t input_size;
+
+    /** The size of the raw buffer. */
+    size_t buffer_size;
+
+    /** Is the input pushed with yaml_parser_feed()? */
+    int push;
+
+    /** Has the last chunk of the pushed input been fed? */
+    int push_final;
+
+    /** Does the parser wait for more pushed input? */
+    int input_needed;
+
     /** The working buffer. */
     struct {
         /** The beginning of the buffer. */
@@ -1167,9 +1341,12 @@ typedef struct yaml_parser_s {
     /** The offset of the current position (in bytes). */
     size_t offset;
 
-    /** The mark of the current position. */
+    /** The mark of the current position (the column is set on demand). */
     yaml_mark_t mark;
 
+    /** The index of the first character of the current line. */
+    size_t line_start;
+
     /**
      * @}
      */
@@ -1188,16 +1365,16 @@ typedef struct yaml_parser_s {
     /** The number of unclosed '[' and '{' indicators. */
     int flow_level;
 
-    /** The tokens queue. */
+    /** The tokens queue (a ring buffer of a power of two size). */
     struct {
-        /** The beginning of the tokens queue. */
+        /** The buffer of the tokens queue. */
         yaml_token_t *start;
-        /** The end of the tokens queue. */
-        yaml_token_t *end;
-        /** The head of the tokens queue. */
-        yaml_token_t *head;
-        /** The tail of the tokens queue. */
-        yaml_token_t *tail;
+        /** The size of the buffer less one. */
+        size_t mask;
+        /** The number of tokens dequeued so far. */
+        size_t head;
+        /** The number of tokens queued so far. */
+        size_t tail;
     } tokens;
 
     /** The number of tokens fetched from the queue. */
@@ -1232,6 +1409,53 @@ typedef struct yaml_parser_s {
         yaml_simple_key_t *top;
     } simple_keys;
 
+    /** The depth of the simple keys stack below which no key is possible. */
+    size_t simple_keys_oldest;
+
+    /** The scanner state to return to if the pushed input runs out. */
+    struct {
+        /** The current position of the buffer. */
+        yaml_char_t *pointer;
+        /** The number of unread characters in the buffer. */
+        size_t unread;
+        /** The mark of the current position. */
+        yaml_mark_t mark;
+        /** The number of unclosed '[' and '{' indicators. */
+        int flow_level;
+        /** The number of tokens in the queue. */
+        size_t tokens;
+        /** The depth of the indentation levels stack. */
+        size_t indents;
+        /** The current indentation level. */
+        int indent;
+        /** May a simple key occur at the current position? */
+        int simple_key_allowed;
+        /** The depth of the simple keys stack. */
+        size_t simple_keys;
+        /** The top of the simple keys stack. */
+        yaml_simple_key_t simple_key;
+    } checkpoint;
+
+    /** The check of a pushed scalar that waits for the rest of the input. */
+    struct {
+        /** The loop the check stopped in, or 0 if no scalar is checked. */
+        int state;
+        /** The index of the first character of the scalar. */
+        size_t index;
+        /** The number of octets checked so far. */
+        size_t offset;
+        /** The column of the position the check stopped at. */
+        size_t column;
+        /** Is there a line break after the last non-blank character? */
+        int leading_blanks;
+        /** The indentation indicator of a block scalar. */
+        int increment;
+        /** The indentation level of a block scalar, or 0 if not known yet. */
+        int indent;
+        /** The greatest indentation of the empty lines checked in a row. */
+        int max_indent;
+    } partial;
+
     /**
      * @}
      */
@@ -1274,6 +1498,32 @@ typedef struct yaml_parser_s {
         yaml_tag_directive_t *top;
     } tag_directives;
 
+    /**
+     * The TAG directives of the current document and the tags resolved with
+     * them (a hash table with open addressing).
+     */
+    struct {
+        /** The beginning of the table. */
+        yaml_tag_data_t *start;
+        /** The end of the table (a power of two slots from the start). */
+        yaml_tag_data_t *end;
+        /** The number of entries in the table. */
+        size_t count;
+    } tags;
+
+    /**
+     * The arena of the current document.  Its blocks are chained through
+     * their first bytes, from the last one.
+     */
+    struct {
+        /** The beginning of the last block. */
+        yaml_char_t *start;
+        /** The free space of the last block. */
+        yaml_char_t *pointer;
+        /** The end of the last block. */
+        yaml_char_t *end;
+    } arena;
+
     /**
      * @}
      */
@@ -1283,14 +1533,14 @@ typedef struct yaml_parser_s {
      * @{
      */
 
-    /** The alias data. */
+    /** The alias data (a hash table of anchors with open addressing). */
     struct {
-        /** The beginning of the list. */
+        /** The beginning of the table. */
         yaml_alias_data_t *start;
-        /** The end of the list. */
+        /** The end of the table (a power of two slots from the start). */
         yaml_alias_data_t *end;
-        /** The top of the list. */
-        yaml_alias_data_t *top;
+        /** The number of anchors in the table. */
+        size_t count;
     } aliases;
 
     /** The currently parsed document. */
@@ -1300,6 +1550,30 @@ typedef struct yaml_parser_s {
      * @}
      */
 
+    /**
+     * The initial storage of the queue and stacks.
+     *
+     * The queue and stacks point here until they grow, so a parser does not
+     * allocate them for small documents.  Therefore a parser object must not
+     * be copied or moved after yaml_parser_initialize().
+     */
+    struct {
+        /** The initial tokens queue. */
+        yaml_token_t tokens[16];
+        /** The initial indentation levels stack. */
+        int indents[16];
+        /** The initial stack of simple keys. */
+        yaml_simple_key_t simple_keys[16];
+        /** The initial parser states stack. */
+        yaml_parser_state_t states[16];
+        /** The initial stack of marks. */
+        yaml_mark_t marks[16];
+        /** The initial list of TAG directives. */
+        yaml_tag_directive_t tag_directives[16];
+        /** The initial table of tags. */
+        yaml_tag_data_t tags[16];
+    } storage;
+
 } yaml_parser_t;
 
 /**
@@ -1325,6 +1599,20 @@ yaml_parser_initialize(yaml_parser_t *parser);
 YAML_DECLARE(void)
 yaml_parser_delete(yaml_parser_t *parser);
 
+/**
+ * Reset a parser for parsing another input.
+ *
+ * The parser returns to the state right after yaml_parser_initialize(), but
+ * keeps its allocated buffers, queues and stacks, so parsing many small
+ * inputs with the same parser does not allocate them again.  The input must
+ * be set again.
+ *
+ * @param[in,out]   parser  A parser object.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_reset(yaml_parser_t *parser);
+
 /**
  * Set a string input.
  *
@@ -1341,6 +1629,24 @@ YAML_DECLARE(void)
 yaml_parser_set_input_string(yaml_parser_t *parser,
         const unsigned char *input, size_t size);
 
+/**
+ * Set a string input that is read in place.
+ *
+ * Unlike yaml_parser_set_input_string(), a UTF-8 @a input is not copied into
+ * the parser buffers: the scanner reads it directly, and the characters are
+ * only checked for validity.  A UTF-16 @a input is decoded as usual.
+ *
+ * The @a input must not be modified while the @a parser object exists.
+ *
+ * @param[in,out]   parser  A parser object.
+ * @param[in]       input   A source data.
+ * @param[in]       size    The length of the source data in bytes.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_input_string_in_place(yaml_parser_t *parser,
+        const unsigned char *input, size_t size);
+
 /**
  * Set a file input.
  *
@@ -1354,6 +1660,23 @@ yaml_parser_set_input_string(yaml_parser_t *parser,
 YAML_DECLARE(void)
 yaml_parser_set_input_file(yaml_parser_t *parser, FILE *file);
 
+/**
+ * Set a memory-mapped file input.
+ *
+ * The rest of @a file, starting from its current position, is mapped into
+ * memory and read in place as by yaml_parser_set_input_string_in_place().  If
+ * the file cannot be mapped (for instance, it is a pipe), it is read as by
+ * yaml_parser_set_input_file().  The mapping is released by
+ * yaml_parser_delete().  The application is responsible for closing the
+ * @a file.
+ *
+ * @param[in,out]   parser  A parser object.
+ * @param[in]       file    An open file.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_input_mmap(yaml_parser_t *parser, FILE *file);
+
 /**
  * Set a generic input handler.
  *
@@ -1367,6 +1690,133 @@ YAML_DECLARE(void)
 yaml_parser_set_input(yaml_parser_t *parser,
         yaml_read_handler_t *handler, void *data);
 
+/**
+ * Feed a chunk of the input to the parser.
+ *
+ * Instead of reading the input with a read handler, the parser may be given
+ * the input chunk by chunk as it arrives.  When the fed chunks are not enough
+ * to produce the next token or event, yaml_parser_scan() and
+ * yaml_parser_parse() succeed with an empty token or event (of the type
+ * @c YAML_NO_TOKEN or @c YAML_NO_EVENT) and set the @c input_needed flag of
+ * the @a parser.  This is also the case before the first chunk.  The call can
+ * be repeated after the next chunk is fed.  The chunks may be split at any
+ * octet, even inside a character.
+ *
+ * An event is produced as soon as the tokens it is made of are complete.  A
+ * scalar cut off by the end of the fed input is checked on from where the
+ * last chunk ended, and scanned once it is complete, so a long scalar may be
+ * fed in small chunks.  The other tokens are short and are scanned again from
+ * their start.
+ *
+ * The pushed input cannot be combined with the other kinds of input, and
+ * yaml_parser_load() expects the whole input to be fed.
+ *
+ * @param[in,out]   parser      A parser object.
+ * @param[in]       input       The next chunk of the input.  It is copied, so
+ *                              it may be reused after the call.
+ * @param[in]       size        The length of the chunk in bytes.
+ * @param[in]       is_final    @c 1 if this is the last chunk of the input.
+ *
+ * @returns @c 1 if the function succeeded, @c 0 on error.
+ */
+
+YAML_DECLARE(int)
+yaml_parser_feed(yaml_parser_t *parser,
+        const unsigned char *input, size_t size, int is_final);
+
+/**
+ * Set the size of the input buffer.
+ *
+ * The parser reads the input from a file or a read handler @a size bytes at a
+ * time (16 KB by default), and decodes it into a buffer three times as large.
+ * A larger buffer means fewer reads for a big stream.  A short string input
+ * still gets a buffer of its own size, and an input read in place or through
+ * a memory mapping does not use the buffer.  Sizes above 64 MB are cut down
+ * to 64 MB.  The size must be set before the input.
+ *
+ * @param[in,out]   parser      A parser object.
+ * @param[in]       size        The size of the raw input buffer in bytes, or
+ *                              @c 0 for the default.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_buffer_size(yaml_parser_t *parser, size_t size);
+
+/**
+ * Let scalar values point into the input.
+ *
+ * When the input is read in place (see
+ * yaml_parser_set_input_string_in_place()), a plain or quoted scalar that
+ * needs no folding or unescaping is not copied: the @c value of its token or
+ * event points into the input and the @c borrowed flag is set.  Such a value
+ * is not NUL-terminated, and it is valid only as long as the input is.
+ * yaml_token_delete() and yaml_event_delete() do not free it.  Other inputs
+ * are not affected.
+ *
+ * @param[in,out]   parser      A parser object.
+ * @param[in]       borrow      @c 1 to borrow scalar values from the input.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_borrow_scalars(yaml_parser_t *parser, int borrow);
+
+/**
+ * Let events share the tags resolved in a document.
+ *
+ * The parser resolves each distinct pair of a tag handle and a suffix once
+ * per document and keeps the tag.  Every scalar, sequence or mapping event
+ * with that pair then points to the same tag and has the @c tag_shared flag
+ * set.  Such a tag is valid until the parser goes on past the DOCUMENT-END
+ * event of its document, and yaml_event_delete() does not free it.  Verbatim
+ * tags are not shared.
+ *
+ * @param[in,out]   parser      A parser object.
+ * @param[in]       share       @c 1 to share the tags of a document.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_share_tags(yaml_parser_t *parser, int share);
+
+/**
+ * Allocate the strings of each document in an arena.
+ *
+ * The anchors, tags, scalar values and other strings that the parser makes
+ * for a document are carved out of large blocks owned by the parser instead
+ * of being allocated one by one.  The tokens and events holding them have the
+ * @c arena flag set, and yaml_token_delete() and yaml_event_delete() do not
+ * free them.  The strings are valid until the parser goes on past the
+ * DOCUMENT-END event of their document, when they are released at once and
+ * the blocks are kept for the next document.  The tokens of
+ * yaml_parser_scan() keep theirs until the parser is reset or deleted.
+ * An input pushed with yaml_parser_feed() does not use the arena.  The mode
+ * must be set before the input.
+ *
+ * @param[in,out]   parser      A parser object.
+ * @param[in]       use         @c 1 to allocate the strings in an arena.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_arena(yaml_parser_t *parser, int use);
+
+/**
+ * Set the allocator of a parser.
+ *
+ * The parser allocates its buffers, queues and stacks, the strings of its
+ * tokens and events, and the documents it loads with @a allocator.  These
+ * tokens, events and documents point to the allocator, and
+ * yaml_token_delete(), yaml_event_delete() and yaml_document_delete() free
+ * them with it, so it must outlive them.  The allocator must be set before the
+ * input.  yaml_parser_reset() keeps it.
+ *
+ * @param[in,out]   parser      A parser object.
+ * @param[in]       allocator   An allocator, or @c NULL for the global
+ *                              allocator.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_set_allocator(yaml_parser_t *parser,
+        const yaml_allocator_t *allocator);
+
 /**
  * Set the source encoding.
  *
@@ -1425,6 +1875,32 @@ yaml_parser_scan(yaml_parser_t *parser, yaml_token_t *token);
 YAML_DECLARE(int)
 yaml_parser_parse(yaml_parser_t *parser, yaml_event_t *event);
 
+/**
+ * Parse the input stream and produce the next parsing events at once.
+ *
+ * The function fills the array @a events with up to @a size events, as many
+ * calls of yaml_parser_parse() would.  A batch ends after a
+ * @c YAML_DOCUMENT_END_EVENT or a @c YAML_STREAM_END_EVENT, so it never holds
+ * events of two documents, and the strings of its events stay valid until the
+ * next call even with yaml_parser_set_share_tags() or yaml_parser_set_arena().
+ * A batch also ends early when a pushed input needs more data.  After the end
+ * of the stream, no events are produced.
+ *
+ * An application is responsible for freeing the @a count produced events
+ * with the yaml_event_delete() function, also when the function fails.
+ *
+ * @param[in,out]   parser      A parser object.
+ * @param[out]      events      An array of at least @a size event objects.
+ * @param[in]       size        The maximum number of events to produce.
+ * @param[out]      count       The number of produced events.
+ *
+ * @returns @c 1 if the function succeeded, @c 0 on error.
+ */
+
+YAML_DECLARE(int)
+yaml_parser_parse_batch(yaml_parser_t *parser, yaml_event_t *events,
+        size_t size, size_t *count);
+
 /**
  * Parse the input stream and produce the next YAML document.
  *
@@ -1475,6 +1951,30 @@ yaml_parser_load(yaml_parser_t *parser, yaml_document_t *document);
 
 typedef int yaml_write_handler_t(void *data, unsigned char *buffer, size_t size);
 
+/**
+ * The prototype of an output buffer handler.
+ *
+ * The output buffer handler lets the emitter write directly into a buffer
+ * owned by the application.  The handler is called when the emitter needs a
+ * bigger buffer and every time the emitter flushes the output.  The handler
+ * should note the @a length of the output and make sure the buffer has room
+ * for at least @a size bytes, moving the buffer if needed.
+ *
+ * @param[in,out]   data        A pointer to an application data specified by
+ *                              yaml_emitter_set_output_buffer().
+ * @param[in]       length      The number of bytes written to the buffer.
+ * @param[in,out]   buffer      The buffer.  The handler may replace it with a
+ *                              bigger one keeping the first @a length bytes.
+ * @param[in,out]   size        The size the emitter needs.  The handler should
+ *                              set it to the actual size of the buffer.
+ *
+ * @returns On success, the handler should return @c 1.  If the handler failed,
+ * the returned value should be @c 0.
+ */
+
+typedef int yaml_output_buffer_handler_t(void *data, size_t length,
+        unsigned char **buffer, size_t *size);
+
 /** The emitter states. */
 typedef enum yaml_emitter_state_e {
     /** Expect STREAM-START. */
@@ -1549,6 +2049,9 @@ typedef struct yaml_emitter_s {
     /** A pointer for passing to the white handler. */
     void *write_handler_data;
 
+    /** Output buffer handler. */
+    yaml_output_buffer_handler_t *output_buffer_handler;
+
     /** Standard (string or file) output data. */
     union {
         /** String output data. */
@@ -1607,6 +2110,10 @@ typedef struct yaml_emitter_s {
     int best_indent;
     /** The preferred width of the output lines. */
     int best_width;
+    /** The size of the working buffer. */
+    size_t buffer_size;
+    /** The allocator of the emitter, or @c NULL for the global allocator. */
+    const yaml_allocator_t *allocator;
     /** Allow unescaped non-ASCII characters? */
     int unicode;
     /** The preferred line break. */
@@ -1625,16 +2132,16 @@ typedef struct yaml_emitter_s {
     /** The current emitter state. */
     yaml_emitter_state_t state;
 
-    /** The event queue. */
+    /** The event queue (a ring buffer of a power of two size). */
     struct {
-        /** The beginning of the event queue. */
+        /** The buffer of the event queue. */
         yaml_event_t *start;
-        /** The end of the event queue. */
-        yaml_event_t *end;
-        /** The head of the event queue. */
-        yaml_event_t *head;
-        /** The tail of the event queue. */
-        yaml_event_t *tail;
+        /** The size of the buffer less one. */
+        size_t mask;
+        /** The number of events dequeued so far. */
+        size_t head;
+        /** The number of events queued so far. */
+        size_t tail;
     } events;
 
     /** The stack of indentation levels. */
@@ -1782,6 +2289,20 @@ yaml_emitter_initialize(yaml_emitter_t *emitter);
 YAML_DECLARE(void)
 yaml_emitter_delete(yaml_emitter_t *emitter);
 
+/**
+ * Reset an emitter for emitting another stream.
+ *
+ * The emitter returns to the state right after yaml_emitter_initialize(), but
+ * keeps its allocated buffers, queues and stacks, so emitting many small
+ * streams with the same emitter does not allocate them again.  The output and
+ * the emitter options must be set again.
+ *
+ * @param[in,out]   emitter An emitter object.
+ */
+
+YAML_DECLARE(void)
+yaml_emitter_reset(yaml_emitter_t *emitter);
+
 /**
  * Set a string output.
  *
@@ -1827,6 +2348,62 @@ YAML_DECLARE(void)
 yaml_emitter_set_output(yaml_emitter_t *emitter,
         yaml_write_handler_t *handler, void *data);
 
+/**
+ * Set the size of the output buffer.
+ *
+ * The emitter collects the output in a buffer of @a size bytes (16 KB by
+ * default) and flushes it to the write handler when it is full.  Sizes above
+ * 64 MB are cut down to 64 MB.  The size must be set before the output.  With
+ * an output buffer handler, the size is the one asked for first.
+ *
+ * @param[in,out]   emitter     An emitter object.
+ * @param[in]       size        The size of the output buffer in bytes, or
+ *                              @c 0 for the default.
+ *
+ * @returns @c 1 if the function succeeded, @c 0 on error.
+ */
+
+YAML_DECLARE(int)
+yaml_emitter_set_buffer_size(yaml_emitter_t *emitter, size_t size);
+
+/**
+ * Set the allocator of an emitter.
+ *
+ * The emitter allocates its buffers, queues and stacks with @a allocator.
+ * The events and documents given to the emitter are freed with their own
+ * allocators.  The allocator must be set before the output.
+ * yaml_emitter_reset() keeps it.
+ *
+ * @param[in,out]   emitter     An emitter object.
+ * @param[in]       allocator   An allocator, or @c NULL for the global
+ *                              allocator.
+ *
+ * @returns @c 1 if the function succeeded, @c 0 on error.
+ */
+
+YAML_DECLARE(int)
+yaml_emitter_set_allocator(yaml_emitter_t *emitter,
+        const yaml_allocator_t *allocator);
+
+/**
+ * Set an application buffer as the output.
+ *
+ * The emitter writes the output directly into the buffer provided by the
+ * @a handler instead of its own working buffer, so the output is not copied.
+ * The output is always encoded in UTF-8.
+ *
+ * @param[in,out]   emitter     An emitter object.
+ * @param[in]       handler     An output buffer handler.
+ * @param[in]       data        Any application data for passing to the output
+ *                              buffer handler.
+ *
+ * @returns @c 1 if the function succeeded, @c 0 if the handler failed.
+ */
+
+YAML_DECLARE(int)
+yaml_emitter_set_output_buffer(yaml_emitter_t *emitter,
+        yaml_output_buffer_handler_t *handler, void *data);
+
 /**
  * Set the output encoding.
  *
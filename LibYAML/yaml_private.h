@@ -10,6 +10,9 @@
 
 /*
  * Memory management.
+ *
+ * The functions with an allocator argument use the global allocator if it is
+ * NULL, like the functions without one.
  */
 
 YAML_DECLARE(void *)
@@ -24,6 +27,33 @@ yaml_free(void *ptr);
 YAML_DECLARE(yaml_char_t *)
 yaml_strdup(const yaml_char_t *);
 
+YAML_DECLARE(void *)
+yaml_allocator_malloc(const yaml_allocator_t *allocator, size_t size);
+
+YAML_DECLARE(void *)
+yaml_allocator_realloc(const yaml_allocator_t *allocator, void *ptr,
+        size_t size);
+
+YAML_DECLARE(void)
+yaml_allocator_free(const yaml_allocator_t *allocator, void *ptr);
+
+YAML_DECLARE(yaml_char_t *)
+yaml_allocator_strdup(const yaml_allocator_t *allocator,
+        const yaml_char_t *str);
+
+/*
+ * Allocate memory with the allocator of a parser, an emitter or a document.
+ */
+
+#define CONTEXT_MALLOC(context,size)                                            \
+    yaml_allocator_malloc((context)->allocator, (size))
+
+#define CONTEXT_FREE(context,pointer)                                           \
+    yaml_allocator_free((context)->allocator, (pointer))
+
+#define CONTEXT_STRDUP(context,string)                                          \
+    yaml_allocator_strdup((context)->allocator, (string))
+
 /*
  * Reader: Ensure that the buffer contains at least `length` characters.
  */
@@ -39,11 +69,69 @@ YAML_DECLARE(int)
 yaml_parser_fetch_more_tokens(yaml_parser_t *parser);
 
 /*
- * The size of the input raw buffer.
+ * Scanner: Ensure that the token queue contains every token of the next event.
+ */
+
+YAML_DECLARE(int)
+yaml_parser_fetch_event_tokens(yaml_parser_t *parser);
+
+/*
+ * Parser: Get the number of tokens the next event is produced from.
+ */
+
+YAML_DECLARE(size_t)
+yaml_parser_event_lookahead(yaml_parser_t *parser);
+
+/*
+ * Parser: Forget the TAG directives and the tags resolved with them.
+ */
+
+YAML_DECLARE(void)
+yaml_parser_delete_tag_directives(yaml_parser_t *parser);
+
+/*
+ * Parser: Destroy a token of the Scanner (see TOKEN_DEL).
+ */
+
+YAML_DECLARE(void)
+yaml_parser_token_delete(yaml_parser_t *parser, yaml_token_t *token);
+
+/*
+ * The default size of the input raw buffer (see
+ * yaml_parser_set_buffer_size()).
  */
 
 #define INPUT_RAW_BUFFER_SIZE   16384
 
+/*
+ * The smallest raw buffer allocated for a short string input.
+ *
+ * Together with the decoded buffer, it should hold the few characters the
+ * scanner looks ahead.
+ */
+
+#define INPUT_MIN_RAW_BUFFER_SIZE   64
+
+/*
+ * The largest raw buffer.  A larger size is cut down, so that the decoded
+ * buffer three times as large cannot overflow.
+ */
+
+#define INPUT_MAX_RAW_BUFFER_SIZE   (64*1024*1024)
+
+/*
+ * The size of the raw buffer of a parser for its input.
+ *
+ * A short input is read at once.  The raw buffer is left a spare octet, so
+ * the end of the input is detected right after reading it.
+ */
+
+#define INPUT_RAW_BUFFER_SIZE_FOR(parser)                                       \
+    (!(parser)->input_size || (parser)->input_size >= (parser)->buffer_size     \
+     ? (parser)->buffer_size                                                    \
+     : (parser)->input_size < INPUT_MIN_RAW_BUFFER_SIZE                         \
+     ? INPUT_MIN_RAW_BUFFER_SIZE : (parser)->input_size+1)
+
 /*
  * The size of the input buffer.
  *
@@ -53,18 +141,40 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser);
 #define INPUT_BUFFER_SIZE       (INPUT_RAW_BUFFER_SIZE*3)
 
 /*
- * The size of the output buffer.
+ * The number of NUL octets kept after the characters of the input buffer.
+ *
+ * They stop the scanner loops over a run of characters (see
+ * yaml_parser_update_buffer()), and cover the longest lookahead.
+ */
+
+#define INPUT_BUFFER_PADDING    4
+
+/*
+ * The default size of the output buffer (see yaml_emitter_set_buffer_size()).
  */
 
 #define OUTPUT_BUFFER_SIZE      16384
 
 /*
- * The size of the output raw buffer.
+ * The smallest output buffer.
+ */
+
+#define OUTPUT_MIN_BUFFER_SIZE  64
+
+/*
+ * The largest output buffer.  A larger size is cut down, so that the raw
+ * buffer twice as large cannot overflow.
+ */
+
+#define OUTPUT_MAX_BUFFER_SIZE  (64*1024*1024)
+
+/*
+ * The size of the output raw buffer for an output buffer of the given size.
  *
  * It should be possible to encode the whole output buffer.
  */
 
-#define OUTPUT_RAW_BUFFER_SIZE  (OUTPUT_BUFFER_SIZE*2+2)
+#define OUTPUT_RAW_BUFFER_SIZE_FOR(size)    ((size)*2+2)
 
 /*
  * The size of other stacks and queues.
@@ -74,12 +184,18 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser);
 #define INITIAL_QUEUE_SIZE  16
 #define INITIAL_STRING_SIZE 16
 
+/*
+ * The size of the first block of a parser arena.
+ */
+
+#define INITIAL_ARENA_SIZE  4096
+
 /*
  * Buffer management.
  */
 
 #define BUFFER_INIT(context,buffer,size)                                        \
-    (((buffer).start = yaml_malloc(size)) ?                                     \
+    (((buffer).start = CONTEXT_MALLOC(context, size)) ?                         \
         ((buffer).last = (buffer).pointer = (buffer).start,                     \
          (buffer).end = (buffer).start+(size),                                  \
          1) :                                                                   \
@@ -87,11 +203,39 @@ yaml_parser_fetch_more_tokens(yaml_parser_t *parser);
          0))
 
 #define BUFFER_DEL(context,buffer)                                              \
-    (yaml_free((buffer).start),                                                 \
-     (buffer).start = (buffer).pointer = (buffer).end = 0)
+    (CONTEXT_FREE(context, (buffer).start),                                     \
+     (buffer).start = (buffer).pointer = (buffer).last = (buffer).end = 0)
+
+/*
+ * Arena management.
+ *
+ * With yaml_parser_set_arena(), the strings the Scanner and the Parser make
+ * for a document are bumped out of the arena of the parser instead of being
+ * allocated one by one.  A pushed input does not use the arena, since the
+ * tokens it queues ahead may belong to the next document.
+ */
+
+#define ARENA_USED(parser)                                                      \
+    ((parser)->use_arena && !(parser)->push)
+
+#define ARENA_MALLOC(parser,size)                                               \
+    (ARENA_USED(parser) ? yaml_arena_alloc((parser), (size))                    \
+     : CONTEXT_MALLOC(parser, size))
+
+#define ARENA_FREE(parser,pointer)                                              \
+    (ARENA_USED(parser) ? (void)0 : CONTEXT_FREE(parser, pointer))
+
+YAML_DECLARE(yaml_char_t *)
+yaml_arena_alloc(yaml_parser_t *parser, size_t size);
+
+YAML_DECLARE(void)
+yaml_arena_release(yaml_parser_t *parser);
 
 /*
  * String management.
+ *
+ * The strings are made by the Scanner, so they live in the arena of the
+ * parser if it uses one.
  */
 
 typedef struct {
@@ -101,11 +245,11 @@ typedef struct {
 } yaml_string_t;
 
 YAML_DECLARE(int)
-yaml_string_extend(yaml_char_t **start,
+yaml_string_extend(yaml_parser_t *parser, yaml_char_t **start,
         yaml_char_t **pointer, yaml_char_t **end);
 
 YAML_DECLARE(int)
-yaml_string_join(
+yaml_string_join(yaml_parser_t *parser,
         yaml_char_t **a_start, yaml_char_t **a_pointer, yaml_char_t **a_end,
         yaml_char_t **b_start, yaml_char_t **b_pointer, yaml_char_t **b_end);
 
@@ -114,7 +258,7 @@ yaml_string_join(
 #define STRING(string,length)   { (string), (string)+(length), (string) }
 
 #define STRING_INIT(context,string,size)                                        \
-    (((string).start = yaml_malloc(size)) ?                                     \
+    (((string).start = ARENA_MALLOC(context, size)) ?                           \
         ((string).pointer = (string).start,                                     \
          (string).end = (string).start+(size),                                  \
          memset((string).start, 0, (size)),                                     \
@@ -123,12 +267,12 @@ yaml_string_join(
          0))
 
 #define STRING_DEL(context,string)                                              \
-    (yaml_free((string).start),                                                 \
+    (ARENA_FREE(context, (string).start),                                       \
      (string).start = (string).pointer = (string).end = 0)
 
 #define STRING_EXTEND(context,string)                                           \
     (((string).pointer+5 < (string).end)                                        \
-        || yaml_string_extend(&(string).start,                                  \
+        || yaml_string_extend((context), &(string).start,                       \
             &(string).pointer, &(string).end))
 
 #define CLEAR(context,string)                                                   \
@@ -136,7 +280,7 @@ yaml_string_join(
      memset((string).start, 0, (string).end-(string).start))
 
 #define JOIN(context,string_a,string_b)                                         \
-    ((yaml_string_join(&(string_a).start, &(string_a).pointer,                  \
+    ((yaml_string_join((context), &(string_a).start, &(string_a).pointer,       \
                        &(string_a).end, &(string_b).start,                      \
                        &(string_b).pointer, &(string_b).end)) ?                 \
         ((string_b).pointer = (string_b).start,                                 \
@@ -161,20 +305,35 @@ yaml_string_join(
 
 #define CHECK(string,octet) CHECK_AT((string),(octet),0)
 
+/*
+ * The character classes of octets.
+ *
+ * An ASCII character is classified by a single lookup.  The octets that may
+ * start a multi-octet line break (NEL, LS, PS) are marked with
+ * YAML_CHAR_LEAD, and the rest of the sequence is checked separately.
+ */
+
+#define YAML_CHAR_ALPHA     0x01    /* [0-9A-Za-z_-] */
+#define YAML_CHAR_DIGIT     0x02    /* [0-9] */
+#define YAML_CHAR_HEX       0x04    /* [0-9A-Fa-f] */
+#define YAML_CHAR_PRINTABLE 0x08    /* #xA | [#x20-#x7E] */
+#define YAML_CHAR_BLANK     0x10    /* #x20 | #x9 */
+#define YAML_CHAR_BREAK     0x20    /* #xD | #xA */
+#define YAML_CHAR_Z         0x40    /* #x0 */
+#define YAML_CHAR_LEAD      0x80    /* #xC2 | #xE2 */
+
+extern YAML_DECLARE(const unsigned char) yaml_char_classes[256];
+
+#define CLASS_AT(string,offset)                                                 \
+    (yaml_char_classes[(string).pointer[offset]])
+
 /*
  * Check if the character at the specified position is an alphabetical
  * character, a digit, '_', or '-'.
  */
 
 #define IS_ALPHA_AT(string,offset)                                              \
-     (((string).pointer[offset] >= (yaml_char_t) '0' &&                         \
-       (string).pointer[offset] <= (yaml_char_t) '9') ||                        \
-      ((string).pointer[offset] >= (yaml_char_t) 'A' &&                         \
-       (string).pointer[offset] <= (yaml_char_t) 'Z') ||                        \
-      ((string).pointer[offset] >= (yaml_char_t) 'a' &&                         \
-       (string).pointer[offset] <= (yaml_char_t) 'z') ||                        \
-      (string).pointer[offset] == '_' ||                                        \
-      (string).pointer[offset] == '-')
+    (CLASS_AT((string),(offset)) & YAML_CHAR_ALPHA)
 
 #define IS_ALPHA(string)    IS_ALPHA_AT((string),0)
 
@@ -183,8 +342,7 @@ yaml_string_join(
  */
 
 #define IS_DIGIT_AT(string,offset)                                              \
-     (((string).pointer[offset] >= (yaml_char_t) '0' &&                         \
-       (string).pointer[offset] <= (yaml_char_t) '9'))
+    (CLASS_AT((string),(offset)) & YAML_CHAR_DIGIT)
 
 #define IS_DIGIT(string)    IS_DIGIT_AT((string),0)
 
@@ -202,12 +360,7 @@ yaml_string_join(
  */
 
 #define IS_HEX_AT(string,offset)                                                \
-     (((string).pointer[offset] >= (yaml_char_t) '0' &&                         \
-       (string).pointer[offset] <= (yaml_char_t) '9') ||                        \
-      ((string).pointer[offset] >= (yaml_char_t) 'A' &&                         \
-       (string).pointer[offset] <= (yaml_char_t) 'F') ||                        \
-      ((string).pointer[offset] >= (yaml_char_t) 'a' &&                         \
-       (string).pointer[offset] <= (yaml_char_t) 'f'))
+    (CLASS_AT((string),(offset)) & YAML_CHAR_HEX)
 
 #define IS_HEX(string)    IS_HEX_AT((string),0)
 
@@ -240,9 +393,8 @@ yaml_string_join(
  */
 
 #define IS_PRINTABLE_AT(string,offset)                                          \
-    (((string).pointer[offset] == 0x0A)         /* . == #x0A */                 \
-     || ((string).pointer[offset] >= 0x20       /* #x20 <= . <= #x7E */         \
-         && (string).pointer[offset] <= 0x7E)                                   \
+    ((CLASS_AT((string),(offset)) & YAML_CHAR_PRINTABLE)                        \
+                                /* . == #x0A || #x20 <= . <= #x7E */            \
      || ((string).pointer[offset] == 0xC2       /* #0xA0 <= . <= #xD7FF */      \
          && (string).pointer[offset+1] >= 0xA0)                                 \
      || ((string).pointer[offset] > 0xC2                                        \
@@ -299,7 +451,7 @@ yaml_string_join(
  */
 
 #define IS_BLANK_AT(string,offset)                                              \
-    (IS_SPACE_AT((string),(offset)) || IS_TAB_AT((string),(offset)))
+    (CLASS_AT((string),(offset)) & YAML_CHAR_BLANK)
 
 #define IS_BLANK(string)    IS_BLANK_AT((string),0)
 
@@ -307,17 +459,20 @@ yaml_string_join(
  * Check if the character at the specified position is a line break.
  */
 
+#define IS_LONG_BREAK_AT(string,offset)                                         \
+    ((CLASS_AT((string),(offset)) & YAML_CHAR_LEAD)                             \
+     && ((CHECK_AT((string),'\xC2',(offset))                                    \
+          && CHECK_AT((string),'\x85',(offset)+1))  /* NEL (#x85) */            \
+         || (CHECK_AT((string),'\xE2',(offset))                                 \
+             && CHECK_AT((string),'\x80',(offset)+1)                            \
+             && CHECK_AT((string),'\xA8',(offset)+2))   /* LS (#x2028) */       \
+         || (CHECK_AT((string),'\xE2',(offset))                                 \
+             && CHECK_AT((string),'\x80',(offset)+1)                            \
+             && CHECK_AT((string),'\xA9',(offset)+2)))) /* PS (#x2029) */
+
 #define IS_BREAK_AT(string,offset)                                              \
-    (CHECK_AT((string),'\r',(offset))               /* CR (#xD)*/               \
-     || CHECK_AT((string),'\n',(offset))            /* LF (#xA) */              \
-     || (CHECK_AT((string),'\xC2',(offset))                                     \
-         && CHECK_AT((string),'\x85',(offset)+1))   /* NEL (#x85) */            \
-     || (CHECK_AT((string),'\xE2',(offset))                                     \
-         && CHECK_AT((string),'\x80',(offset)+1)                                \
-         && CHECK_AT((string),'\xA8',(offset)+2))   /* LS (#x2028) */           \
-     || (CHECK_AT((string),'\xE2',(offset))                                     \
-         && CHECK_AT((string),'\x80',(offset)+1)                                \
-         && CHECK_AT((string),'\xA9',(offset)+2)))  /* PS (#x2029) */
+    ((CLASS_AT((string),(offset)) & YAML_CHAR_BREAK)   /* CR (#xD), LF (#xA) */ \
+     || IS_LONG_BREAK_AT((string),(offset)))
 
 #define IS_BREAK(string)    IS_BREAK_AT((string),0)
 
@@ -331,7 +486,8 @@ yaml_string_join(
  */
 
 #define IS_BREAKZ_AT(string,offset)                                             \
-    (IS_BREAK_AT((string),(offset)) || IS_Z_AT((string),(offset)))
+    ((CLASS_AT((string),(offset)) & (YAML_CHAR_BREAK | YAML_CHAR_Z))            \
+     || IS_LONG_BREAK_AT((string),(offset)))
 
 #define IS_BREAKZ(string)   IS_BREAKZ_AT((string),0)
 
@@ -349,7 +505,9 @@ yaml_string_join(
  */
 
 #define IS_BLANKZ_AT(string,offset)                                             \
-    (IS_BLANK_AT((string),(offset)) || IS_BREAKZ_AT((string),(offset)))
+    ((CLASS_AT((string),(offset))                                               \
+      & (YAML_CHAR_BLANK | YAML_CHAR_BREAK | YAML_CHAR_Z))                      \
+     || IS_LONG_BREAK_AT((string),(offset)))
 
 #define IS_BLANKZ(string)   IS_BLANKZ_AT((string),0)
 
@@ -396,13 +554,37 @@ yaml_string_join(
  */
 
 YAML_DECLARE(int)
-yaml_stack_extend(void **start, void **top, void **end);
+yaml_stack_extend(const yaml_allocator_t *allocator,
+        void **start, void **top, void **end, int is_inline);
 
 YAML_DECLARE(int)
-yaml_queue_extend(void **start, void **head, void **tail, void **end);
+yaml_queue_extend(const yaml_allocator_t *allocator,
+        void **start, size_t *mask, size_t *head, size_t *tail,
+        size_t size, int is_inline);
+
+YAML_DECLARE(void)
+yaml_queue_insert(void *start, size_t mask, size_t head, size_t tail,
+        size_t index, size_t size);
+
+/*
+ * Check if a stack or a queue uses the storage inside the context object.
+ */
+
+#define IS_INLINE(context,pointer)                                              \
+    ((char *)(pointer) >= (char *)(context)                                     \
+     && (char *)(pointer) < (char *)((context)+1))
+
+#define STACK_INIT_INLINE(context,stack,storage)                                \
+    ((stack).start = (stack).top = (storage),                                   \
+     (stack).end = (storage)+sizeof(storage)/sizeof(*(storage)))
+
+#define QUEUE_INIT_INLINE(context,queue,storage)                                \
+    ((queue).start = (storage),                                                 \
+     (queue).head = (queue).tail = 0,                                           \
+     (queue).mask = sizeof(storage)/sizeof(*(storage))-1)
 
 #define STACK_INIT(context,stack,size)                                          \
-    (((stack).start = yaml_malloc((size)*sizeof(*(stack).start))) ?             \
+    (((stack).start = CONTEXT_MALLOC(context, (size)*sizeof(*(stack).start))) ? \
         ((stack).top = (stack).start,                                           \
          (stack).end = (stack).start+(size),                                    \
          1) :                                                                   \
@@ -410,7 +592,8 @@ yaml_queue_extend(void **start, void **head, void **tail, void **end);
          0))
 
 #define STACK_DEL(context,stack)                                                \
-    (yaml_free((stack).start),                                                  \
+    (IS_INLINE(context, (stack).start) ? (void)0                                \
+     : CONTEXT_FREE(context, (stack).start),                                    \
      (stack).start = (stack).top = (stack).end = 0)
 
 #define STACK_EMPTY(context,stack)                                              \
@@ -418,8 +601,9 @@ yaml_queue_extend(void **start, void **head, void **tail, void **end);
 
 #define PUSH(context,stack,value)                                               \
     (((stack).top != (stack).end                                                \
-      || yaml_stack_extend((void **)&(stack).start,                             \
-              (void **)&(stack).top, (void **)&(stack).end)) ?                  \
+      || yaml_stack_extend((context)->allocator, (void **)&(stack).start,       \
+              (void **)&(stack).top, (void **)&(stack).end,                     \
+              IS_INLINE(context, (stack).start))) ?                             \
         (*((stack).top++) = value,                                              \
          1) :                                                                   \
         ((context)->error = YAML_MEMORY_ERROR,                                  \
@@ -428,45 +612,70 @@ yaml_queue_extend(void **start, void **head, void **tail, void **end);
 #define POP(context,stack)                                                      \
     (*(--(stack).top))
 
+/*
+ * A queue is a ring buffer of a power of two size.  The head and the tail
+ * count the items dequeued and queued so far, and the size less one masks
+ * them into positions in the buffer.
+ */
+
 #define QUEUE_INIT(context,queue,size)                                          \
-    (((queue).start = yaml_malloc((size)*sizeof(*(queue).start))) ?             \
-        ((queue).head = (queue).tail = (queue).start,                           \
-         (queue).end = (queue).start+(size),                                    \
+    (((queue).start = CONTEXT_MALLOC(context, (size)*sizeof(*(queue).start))) ? \
+        ((queue).head = (queue).tail = 0,                                       \
+         (queue).mask = (size)-1,                                               \
          1) :                                                                   \
         ((context)->error = YAML_MEMORY_ERROR,                                  \
          0))
 
 #define QUEUE_DEL(context,queue)                                                \
-    (yaml_free((queue).start),                                                  \
-     (queue).start = (queue).head = (queue).tail = (queue).end = 0)
+    (IS_INLINE(context, (queue).start) ? (void)0                                \
+     : CONTEXT_FREE(context, (queue).start),                                    \
+     (queue).start = 0,                                                         \
+     (queue).head = (queue).tail = (queue).mask = 0)
 
 #define QUEUE_EMPTY(context,queue)                                              \
     ((queue).head == (queue).tail)
 
+#define QUEUE_LENGTH(context,queue)                                             \
+    ((queue).tail - (queue).head)
+
+#define QUEUE_AT(context,queue,index)                                           \
+    ((queue).start[((queue).head+(index)) & (queue).mask])
+
+#define QUEUE_EXTEND(context,queue)                                             \
+    ((queue).tail - (queue).head <= (queue).mask                                \
+      || yaml_queue_extend((context)->allocator,                                \
+            (void **)&(queue).start, &(queue).mask,                             \
+            &(queue).head, &(queue).tail, sizeof(*(queue).start),               \
+            IS_INLINE(context, (queue).start)))
+
 #define ENQUEUE(context,queue,value)                                            \
-    (((queue).tail != (queue).end                                               \
-      || yaml_queue_extend((void **)&(queue).start, (void **)&(queue).head,     \
-            (void **)&(queue).tail, (void **)&(queue).end)) ?                   \
-        (*((queue).tail++) = value,                                             \
+    (QUEUE_EXTEND(context,queue) ?                                              \
+        ((queue).start[(queue).tail++ & (queue).mask] = value,                  \
          1) :                                                                   \
         ((context)->error = YAML_MEMORY_ERROR,                                  \
          0))
 
 #define DEQUEUE(context,queue)                                                  \
-    (*((queue).head++))
+    ((queue).start[(queue).head++ & (queue).mask])
 
 #define QUEUE_INSERT(context,queue,index,value)                                 \
-    (((queue).tail != (queue).end                                               \
-      || yaml_queue_extend((void **)&(queue).start, (void **)&(queue).head,     \
-            (void **)&(queue).tail, (void **)&(queue).end)) ?                   \
-        (memmove((queue).head+(index)+1,(queue).head+(index),                   \
-            ((queue).tail-(queue).head-(index))*sizeof(*(queue).start)),        \
-         *((queue).head+(index)) = value,                                       \
+    (QUEUE_EXTEND(context,queue) ?                                              \
+        (yaml_queue_insert((queue).start, (queue).mask, (queue).head,           \
+            (queue).tail, (index), sizeof(*(queue).start)),                     \
+         QUEUE_AT(context,queue,index) = value,                                 \
          (queue).tail++,                                                        \
          1) :                                                                   \
         ((context)->error = YAML_MEMORY_ERROR,                                  \
          0))
 
+/*
+ * Destroy a token made by the Scanner.  Its strings may live in the arena or
+ * come from the allocator of the parser.
+ */
+
+#define TOKEN_DEL(parser,token)                                                 \
+    (yaml_parser_token_delete((parser), &(token)))
+
 /*
  * Token initializers.
  */
@@ -0,0 +1,45 @@
+# Time the loading of deeply nested flow collections.
+#
+# Loading a stream four times as deep should take about four times as long,
+# not sixteen times as it did when every token rechecked each flow level.
+# The times depend on the machine and its load, so this is not a part of
+# 'make test'.  Run it after building:
+#
+#     perl -Mblib bench/nesting.pl [rounds]
+#
+# It prints the best time of each depth and exits with 1 if a depth four
+# times as large took more than ten times as long.
+
+use strict;
+use warnings;
+use Time::HiRes qw(time);
+use YAML::XS;
+
+my $rounds = shift || 5;
+
+sub nested {
+    my $depth = shift;
+    ('{a: [' x $depth) . '1' . (']}' x $depth);
+}
+
+sub load_time {
+    my $yaml = nested(shift);
+    my $best;
+    for (1 .. $rounds) {
+        my $start = time;
+        YAML::XS::Load($yaml);
+        my $took = time - $start;
+        $best = $took if !defined $best or $took < $best;
+    }
+    return $best;
+}
+
+my %took;
+for my $depth (5000, 10000, 20000) {
+    $took{$depth} = load_time($depth);
+    printf "depth %6d: %.4fs\n", $depth, $took{$depth};
+}
+
+my $ratio = $took{20000} / ($took{5000} || 1e-6);
+printf "20000/5000: %.1fx\n", $ratio;
+exit($ratio > 10 ? 1 : 0);
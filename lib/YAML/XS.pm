@@ -53,13 +53,17 @@ sub DumpFile {
         open $OUT, $mode, $filename
           or die "Can't open '$filename' for output:\n$!";
     }
-    local $/ = "\n"; # reset special to "sane"
-    print $OUT YAML::XS::LibYAML::Dump(@_);
+    YAML::XS::LibYAML::DumpFile($OUT, @_);
 }
 
 sub LoadFile {
     my $IN;
     my $filename = shift;
+    if (ref $filename ne 'GLOB') {
+        my ($name) = $filename =~ /^\s*(?:<\s*)?(.*?)\s*$/s;
+        return YAML::XS::LibYAML::LoadFile($name)
+          unless $name eq '-' or $name =~ /^[|+>&]|\|$/;
+    }
     if (ref $filename eq 'GLOB') {
         $IN = $filename;
     }
@@ -175,6 +179,39 @@ support to date.
 This module exports the functions C<Dump> and C<Load>. These functions
 are intended to work exactly like C<YAML.pm>'s corresponding functions.
 
+C<DumpFile($file_or_handle, @docs)> writes the YAML stream to the handle
+piece by piece as it is emitted, so the whole stream is never held in
+memory.
+The bytes written are the same as C<print $fh Dump(@docs)> would write,
+also to a handle with a C<:utf8> or C<:encoding> layer.
+
+To load a long stream of documents without holding all of them in memory,
+feed it in chunks to a C<YAML::XS::LibYAML::Stream> object and take each
+document as soon as it is complete:
+
+    my $stream = YAML::XS::LibYAML::Stream->new;
+    while (read $fh, my $chunk, 65536) {
+        $stream->feed($chunk);
+        while (my ($doc) = $stream->next_document) { ... }
+    }
+    $stream->finish;
+    while (my ($doc) = $stream->next_document) { ... }
+
+C<next_document> returns an empty list when no complete document is
+available.  A document is complete once its C<...> line is fed, or else once
+the next document starts or the stream is finished.  A stream object is
+not copied into a new thread; the new thread sees it as C<undef>.
+
+The parser reads a stream and the emitter writes one through buffers of
+16 KB. Set C<$YAML::XS::BufferSize> to another size in bytes before a call
+to use bigger buffers for large streams, or smaller ones:
+
+    local $YAML::XS::BufferSize = 4 * 1024 * 1024;
+    YAML::XS::DumpFile($fh, @docs);
+
+Sizes above 64 MB are cut down to 64 MB.  If the buffers cannot be
+allocated, the call dies with an error.
+
 =head1 SEE ALSO
 
  * YAML.pm
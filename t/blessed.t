@@ -1,4 +1,4 @@
-use t::TestYAMLTests tests => 10;
+use t::TestYAMLTests tests => 11;
 
 filters {
     perl => 'eval',
@@ -43,6 +43,18 @@ $yaml = Dump($array2);
 
 is $yaml, $test->yaml_dump, "Dumping " . $test->name . " works";
 
+######
+my @docs = Load(<<'EOY');
+%TAG !p! tag:yaml.org,2002:perl/hash:
+--- [!p!Foo {}, !p!Bar {}, !p!Foo {a: !p!Foo {}}]
+...
+%TAG !p! tag:yaml.org,2002:perl/array:
+--- [!p!Foo [], !p!Foo []]
+EOY
+is_deeply [map { [map { /^(\w+)=(\w+)/ && "$1 $2" } @$_] } @docs],
+    [['Foo HASH', 'Bar HASH', 'Foo HASH'], ['Foo ARRAY', 'Foo ARRAY']],
+    'Tag handles resolve with the directives of their own document';
+
 __DATA__
 === Blessed Hashes and Arrays
 +++ yaml
@@ -1,4 +1,4 @@
-use t::TestYAMLTests tests => 4;
+use t::TestYAMLTests tests => 6;
 
 spec_file('t/data/basic.t');
 filters {
@@ -7,6 +7,16 @@ filters {
 
 run_is perl => 'libyaml_emit';
 
+{
+    no warnings 'once';
+    local $YAML::XS::DumpCode = 1;
+    local $YAML::XS::coderef2text = sub { Dump([1]) };
+    is Dump([sub {}]), "---\n- !!perl/code |\n  ---\n  - 1\n",
+        'Dump can be called while dumping';
+}
+
+is Dump([2]), "---\n- 2\n", 'Dump works after a nested Dump';
+
 sub test_dump {
     Dump(@_) || "Dump failed";
 }
@@ -1,4 +1,4 @@
-use t::TestYAMLTests tests => 24;
+use t::TestYAMLTests tests => 32;
 
 filters {
     error => ['lines', 'chomp'],
@@ -63,6 +63,18 @@ line: 2
 column: 6
 while scanning an alias
 
+=== Unexpected indicator after a flow sequence
++++ yaml
+---
+foo: [1,
+  2, {a: b}
+  ] ]
++++ error
+did not find expected key
+line: 4, column: 5
+while parsing a block mapping
+line: 2, column: 1
+
 === Bad tag for array
 +++ yaml
 --- !!foo []
@@ -78,3 +90,13 @@ bad tag found for hash: 'tag:yaml.org,2002:!foo'
 document: 1
 !line:
 !column:
+
+=== A loader error ahead of a scanner error
++++ yaml
+--- !!p]erl/hash:Foo {a: 1-}
+	- t:ab
++++ error
+bad tag found for hash
+document: 1
+!line:
+!while scanning
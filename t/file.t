@@ -1,4 +1,4 @@
-use t::TestYAML tests => 7;
+use t::TestYAML tests => 21;
 
 use YAML::XS qw'LoadFile';
 
@@ -29,3 +29,81 @@ YAML::XS::DumpFile($test_file, $t3, $t4);
 my ($t3_, $t4_) = LoadFile($test_file);
 
 is_deeply [$t3_, $t4_], [$t3, $t4], 'Unicode roundtrip ok';
+
+open my $out, '>', $test_file or die $!;
+print $out "\xFF\xFE-\0-\0-\0 \0\x00\x01\n\0";
+close $out;
+
+is LoadFile($test_file), "\x{100}", 'Loading a UTF-16 file works';
+
+open $out, '>', $test_file or die $!;
+close $out;
+
+my @docs = LoadFile($test_file);
+is scalar(@docs), 0, 'Loading an empty file works';
+@docs = YAML::XS::LibYAML::LoadFile($test_file);
+is scalar(@docs), 0, 'The XS loader reads an empty file';
+
+open $out, '>', $test_file or die $!;
+print $out "# header\n";
+YAML::XS::DumpFile($out, $t1, $t2);
+close $out;
+
+open my $in, '<', $test_file or die $!;
+my $text = do { local $/; <$in> };
+close $in;
+is $text, "# header\n" . YAML::XS::Dump($t1, $t2),
+    'DumpFile writes to an open filehandle';
+
+YAML::XS::DumpFile(">>$test_file", $t3);
+is_deeply [LoadFile($test_file)], [$t1, $t2, $t3], 'DumpFile can append';
+is_deeply [LoadFile(" < $test_file ")], [$t1, $t2, $t3],
+    'LoadFile takes a file name with a read mode';
+
+{
+    package TiedOutput;
+    sub TIEHANDLE { my ($class, $text) = @_; bless $text, $class }
+    sub PRINT { my $text = shift; $$text .= join '', @_; 1 }
+}
+tie *TIED, 'TiedOutput', \my $tied_text;
+YAML::XS::DumpFile(\*TIED, $t1, $t2);
+is $tied_text, YAML::XS::Dump($t1, $t2), 'DumpFile prints to a tied filehandle';
+
+{
+    local $\ = "# end\n";
+    YAML::XS::DumpFile($test_file, $t1);
+}
+open $in, '<', $test_file or die $!;
+$text = do { local $/; <$in> };
+close $in;
+is $text, YAML::XS::Dump($t1) . "# end\n", 'DumpFile ends with $\ like print';
+
+for my $layer (':utf8', ':encoding(UTF-8)') {
+    my $data = {"caf\x{e9}" => "\x{263a}"};
+    open $out, ">$layer", $test_file or die $!;
+    YAML::XS::DumpFile($out, $data);
+    close $out;
+    open $in, '<:raw', $test_file or die $!;
+    $text = do { local $/; <$in> };
+    close $in;
+    my $printed = YAML::XS::Dump($data);
+    utf8::upgrade($printed);
+    utf8::encode($printed);
+    is $text, $printed, "DumpFile writes to a $layer handle like print";
+}
+
+open $in, '<', $test_file or die $!;
+eval { YAML::XS::LibYAML::DumpFile($in, $t1) };
+like $@, qr/Filehandle is not opened for output/,
+    'DumpFile dies on a read-only filehandle';
+close $in;
+
+{
+    my $big = {map { ("key $_" => ["value $_" x 3, {n => $_}]) } 1 .. 500};
+    for my $size (1, 1 << 20, 2 ** 60) {
+        local $YAML::XS::BufferSize = $size;
+        YAML::XS::DumpFile($test_file, $big);
+        is_deeply LoadFile($test_file), $big,
+            "File roundtrip with \$YAML::XS::BufferSize = $size ok";
+    }
+}
@@ -1,4 +1,4 @@
-use t::TestYAMLTests tests => 5;
+use t::TestYAMLTests tests => 13;
 
 spec_file('t/data/basic.t');
 filters {
@@ -8,6 +8,51 @@ filters {
 
 run_is_deeply yaml => 'perl';
 
+eval { Load("--- [1, 2\n") };
+is_deeply [Load("--- [1, 2]\n")], [[1, 2]], 'Load works after a failed Load';
+
+is_deeply [map { Load($_) } "\xFF\xFE-\0-\0-\0 \0x\0\n\0", "--- y\n"],
+    ['x', 'y'], 'Load works after loading a UTF-16 stream';
+
+is_deeply Load(<<'...'),
+{a: plain words, b: 'single ''quoted''', c: "double\tquoted",
+d: folded
+  plain, e: true, f: truex, g: ~, h: 'end'}
+...
+    {a => 'plain words', b => "single 'quoted'", c => "double\tquoted",
+     d => 'folded plain', e => 1, f => 'truex', g => undef, h => 'end'},
+    'Scalars read from the input and copied ones load the same';
+
+is_deeply [Load("--- 'true'"), Load("--- 'x y'"), Load("--- x y")],
+    ['true', 'x y', 'x y'], 'Scalars at the end of the input load';
+
+my $long = join '', map { "k$_: 'a  b'   # note\nl$_: [ 1,   2 ,\t3 ]\n" } 1 .. 5000;
+is_deeply [map { Load("---\n${long}z: end$_") } '', '   # last', "\r\n"],
+    [({map({ ("k$_" => 'a  b', "l$_" => [1, 2, 3]) } 1 .. 5000), z => 'end'})
+        x 3],
+    'Runs of blanks and comments end at line breaks and at the end';
+
+is_deeply [map { [values %{Load('[' . join(', ', 1 .. $_) . "]: v\n")}] }
+        1, 15, 16, 17, 100],
+    [(['v']) x 5], 'Simple keys ahead of many queued tokens load';
+
+my @lines = map { "SELECT col_$_\tFROM t WHERE name = 'x # y';" } 1 .. 200;
+is_deeply Load("a: |\n" . join('', map { "    $_\n" } @lines)
+        . "b: >-\n  folded\n  line\n\n    more\n  end\n"),
+    {a => join('', map { "$_\n" } @lines), b => "folded line\n\n  more\nend"},
+    'Long literal and folded block scalars load';
+
+my $docs = join '', map {
+    "%TAG !e! tag:yaml.org,2002:perl/hash:\n--- !e!Doc$_\n"
+    . join('', map { "k$_: &a$_ v$_\nl$_: [*a$_]\n" } 1 .. 40)
+    . "...\n"
+} 1 .. 3;
+my @loaded = Load($docs);
+is_deeply [map { [ref $_, {%$_}] } @loaded],
+    [map { ["Doc$_", {map { ("k$_" => "v$_", "l$_" => ["v$_"]) } 1 .. 40}] }
+        1 .. 3],
+    'Documents longer than an event batch load';
+
 sub parse_to_byte {
     Load($_);
 }
@@ -0,0 +1,15 @@
+use t::TestYAMLTests tests => 2;
+
+sub nested {
+    my $depth = shift;
+    ('{a: [' x $depth) . '1' . (']}' x $depth);
+}
+
+my $data = Load(nested(1000));
+my $depth = 0;
+while (ref $data eq 'HASH') {
+    $data = $data->{a}[0];
+    $depth ++;
+}
+is $depth, 1000, 'Deeply nested flow collections load';
+is $data, 1, 'The innermost value of nested flow collections loads';
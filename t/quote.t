@@ -1,4 +1,4 @@
-use t::TestYAMLTests tests => 4;
+use t::TestYAMLTests tests => 5;
 
 is Dump('', [''], {foo => ''}), <<'...', 'Dumped empty string is quoted';
 --- ''
@@ -35,3 +35,14 @@ is Dump(['&1', '*1', '|2', '? foo', 'x: y', "\a\t\n\r"]), <<'...',
 ...
 'Dumped special scalars get quoted';
 
+is_deeply Load(<<'...'),
+- "a long run of plain text, then \"escapes\"\tand\u00e9 trailing  "
+- 'single ''quoted'' text with trailing spaces   
+  on a folded line'
+- "text # not a comment: \
+  continued"
+...
+    ["a long run of plain text, then \"escapes\"\tand\x{e9} trailing  ",
+     "single 'quoted' text with trailing spaces on a folded line",
+     "text # not a comment: continued"],
+    'Quoted scalars with runs of plain text load';
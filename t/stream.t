@@ -0,0 +1,141 @@
+use t::TestYAML tests => 18;
+
+use YAML::XS;
+use Config;
+
+my $yaml = <<'END';
+---
+name: first
+list: [1, 2, 3]
+--- &a
+name: second
+self: *a
+--- just a string
+---
+name: fourth
+list: [4, 5]
+...
+END
+
+my $stream = YAML::XS::LibYAML::Stream->new;
+my @docs;
+for my $chunk ($yaml =~ /(.{1,5})/sg) {
+    $stream->feed($chunk);
+    while (my ($doc) = $stream->next_document) {
+        push @docs, $doc;
+    }
+}
+is scalar(@docs), 4, 'Documents are loaded as soon as they are complete';
+
+$stream->finish;
+while (my ($doc) = $stream->next_document) {
+    push @docs, $doc;
+}
+is scalar(@docs), 4, 'No document is left for finish';
+
+is_deeply $docs[0], {name => 'first', list => [1, 2, 3]},
+    'First streamed document is ok';
+is $docs[1]{self}, $docs[1], 'Anchors work in a streamed document';
+is $docs[2], 'just a string', 'Last streamed document is ok';
+
+is_deeply [YAML::XS::LibYAML::Stream->new->next_document], [],
+    'No document without input';
+
+$stream = YAML::XS::LibYAML::Stream->new;
+$stream->feed("--- {id: 1}\n...\n");
+is_deeply [$stream->next_document], [{id => 1}],
+    'A document ending with ... is loaded before the next one starts';
+
+$stream = YAML::XS::LibYAML::Stream->new;
+$stream->feed("--- {id: 2}\n");
+is_deeply [$stream->next_document], [], 'An open document waits for input';
+$stream->finish;
+is_deeply [$stream->next_document], [{id => 2}],
+    'The last document is loaded after finish';
+
+$stream = YAML::XS::LibYAML::Stream->new;
+$stream->feed("--- [1, 2\n--- 3\n");
+$stream->finish;
+eval { $stream->next_document };
+like $@, qr/did not find expected ',' or ']'/,
+    'Errors in a streamed document are reported';
+
+eval { $stream->feed("x") };
+like $@, qr/Can't feed a finished stream/, 'Feeding after finish dies';
+
+$stream = YAML::XS::LibYAML::Stream->new;
+$stream->feed("--- " . "x" x 500);
+is_deeply [$stream->next_document], [], 'A cut off scalar waits for input';
+$stream->feed("x\n--- a\n--- b\n--- c\n");
+@docs = ();
+while (my ($doc) = $stream->next_document) {
+    push @docs, $doc;
+}
+is_deeply \@docs, ["x" x 501, 'a', 'b'],
+    'A cut off scalar is completed by the new input';
+
+my $scalars = <<'END';
+- plain words
+  folded over lines
+
+  and a paragraph
+- 'single ''quoted''
+  text'
+- "double \x41\u00e9 \
+  escaped"
+- |+2
+    literal
+   text
+
+- >-
+  folded
+  text
+END
+my $expected = YAML::XS::Load($scalars);
+for my $size (1, 7) {
+    $stream = YAML::XS::LibYAML::Stream->new;
+    my @early;
+    for my $chunk ($scalars =~ /(.{1,$size})/sg) {
+        $stream->feed($chunk);
+        push @early, $stream->next_document;
+    }
+    $stream->finish;
+    is_deeply [@early, $stream->next_document], [$expected],
+        "Scalars resume across chunks of $size octets";
+}
+
+{
+    my $long = join ' ', ('word') x 400_000;
+    my $value;
+    local $SIG{ALRM} = sub { die "timeout\n" };
+    alarm 60;
+    eval {
+        $stream = YAML::XS::LibYAML::Stream->new;
+        my $input = "--- $long\n...\n";
+        for (my $i = 0; $i < length $input; $i += 64) {
+            $stream->feed(substr $input, $i, 64);
+            ($value) = $stream->next_document;
+        }
+    };
+    alarm 0;
+    is $value, $long,
+        'A long scalar fed in small chunks is checked on, not scanned again';
+}
+
+for my $input ("--- {k1: v1", "--- [a, &b b, *b", "%YAML 1.1\n--- [\n a, b: c,\n d\nx\n") {
+    my $unfinished = YAML::XS::LibYAML::Stream->new;
+    $unfinished->feed($input);
+    eval { $unfinished->next_document };
+}
+pass 'Streams are destroyed with tokens still queued';
+
+SKIP: {
+    skip 'This perl has no threads', 1 unless $Config{useithreads};
+    require threads;
+    $stream = YAML::XS::LibYAML::Stream->new;
+    $stream->feed("--- {id: 3");
+    threads->create(sub { 1 })->join;
+    $stream->feed("}\n...\n");
+    is_deeply [$stream->next_document], [{id => 3}],
+        'A stream is not cloned into a new thread';
+}
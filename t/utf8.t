@@ -1,8 +1,9 @@
-use t::TestYAMLTests tests => 8;
+use t::TestYAMLTests tests => 11;
 use utf8;
 
 is Dump("\x{100}"), "--- \xC4\x80\n", 'Dumping wide char works';
 is Load("--- \xC4\x80\n"), "\x{100}", 'Loading UTF-8 works';
+is Load("\xEF\xBB\xBF--- \xC4\x80\n"), "\x{100}", 'Loading UTF-8 with a BOM works';
 is Load("\xFE\xFF\0-\0-\0-\0 \x01\x00\0\n"), "\x{100}", 'Loading UTF-16BE works';
 is Load("\xFF\xFE-\0-\0-\0 \0\x00\x01\n\0"), "\x{100}", 'Loading UTF-16LE works';
 
@@ -65,3 +66,10 @@ utf8::encode($yaml2);
 
 is Dump($hash2), $yaml2, 'Dumping Japanese hash works';
 is_deeply Load($yaml2), $hash2, 'Loading Japanese hash works';
+
+my $long = ('x' x 40) . "\xC4\x80" . ('y' x 40);
+is Load("--- $long\n"), ('x' x 40) . "\x{100}" . ('y' x 40),
+    'Loading UTF-8 inside long ASCII runs works';
+eval { Load("--- " . ('x' x 40) . "\x01\n") };
+like $@, qr/Control characters are not allowed/,
+    'Control characters inside long ASCII runs are rejected';